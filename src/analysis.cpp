@@ -1,5 +1,6 @@
 #include "analysis.h"
 #include "move.h"
+#include "context.h"
 #include "energy.h"
 #include "reactioncoordinate.h"
 #include "multipole.h"
@@ -9,6 +10,11 @@
 
 #include <iomanip>
 #include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <typeinfo>
 
 namespace Faunus {
 
@@ -31,6 +37,7 @@ void Analysisbase::sample() {
         stepcnt = 0;
         if (totstepcnt > nskip) {
             cnt++;
+            sampledsteps += steps;
             timer.start();
             _sample();
             timer.stop();
@@ -38,9 +45,63 @@ void Analysisbase::sample() {
     }
 }
 
+void Analysisbase::observe(double x) {
+    if (std::isfinite(x)) {
+        if (not merged)
+            blocks += x;
+        if (adaptive) {
+            window += x;
+            adapt();
+        }
+    }
+}
+
+/**
+ * The sample interval is stretched to approximately one correlation time of the
+ * observable, estimated by blocking a window of samples taken with the current
+ * interval. The interval is never shortened as that would merely add correlated samples.
+ */
+void Analysisbase::adapt() {
+    if (window.size() >= 512) {
+        double tau = window.correlation(); // in units of samples
+        if (tau > 1) {
+            int newsteps = std::min(maxsteps, int(std::lround(steps * tau)));
+            if (newsteps > steps) {
+                faunus_logger->debug("{}: sample interval {} -> {}", name, steps, newsteps);
+                steps = newsteps;
+                stepcnt = 0;
+            }
+        }
+        window.clear();
+    }
+}
+
+bool Analysisbase::isDue(int step) const { return steps > 0 and step % steps == 0 and step > nskip; }
+
+void Analysisbase::merge(const Analysisbase &other) {
+    if (typeid(*this) != typeid(other))
+        throw std::runtime_error("cannot merge " + name + " with " + other.name);
+    _merge(other);
+    cnt += other.cnt;
+    sampledsteps += other.sampledsteps;
+    merged = true; // blocks of interleaved samples do not measure correlation
+    blocks.clear();
+}
+
+void Analysisbase::_merge(const Analysisbase &) { throw std::runtime_error(name + " cannot be merged"); }
+
+void Analysisbase::validate() const {
+    if (adaptive and observable.empty())
+        throw std::runtime_error(name + ": adaptive sampling requires an analysis with an observable");
+}
+
 void Analysisbase::from_json(const json &j) {
     steps = j.value("nstep", 0);
     nskip = j.value("nskip", 0);
+    adaptive = j.value("adaptive", false);
+    maxsteps = j.value("nstepmax", 100 * steps);
+    if (adaptive and steps < 1)
+        throw std::runtime_error("adaptive sampling requires nstep > 0");
     _from_json(j);
 }
 
@@ -55,6 +116,15 @@ void Analysisbase::to_json(json &j) const {
         _j["samples"] = cnt;
         if (nskip > 0)
             _j["nskip"] = nskip;
+        if (adaptive) {
+            _j["adaptive"] = true;
+            _j["nstepmax"] = maxsteps;
+        }
+        if (not blocks.empty())
+            _j["blocking"] = {{"observable", observable},
+                              {"mean", blocks.avg()},
+                              {"error", blocks.error()},
+                              {"inefficiency", _round(blocks.inefficiency())}};
     }
     if (not cite.empty())
         _j["reference"] = cite;
@@ -72,14 +142,33 @@ void SystemEnergy::normalize() {
     }
 }
 
+/**
+ * The running energy kept by the Hamiltonian is used when in sync with the system.
+ * Every `recompute` samples, or if the running energy is unavailable, all terms are
+ * evaluated and the running energy is reset, warning if the two differ.
+ */
 void SystemEnergy::_sample() {
-    auto ulist = energyFunc();
+    std::vector<double> ulist;
+    bool due = recompute > 0 and (cnt - 1) % recompute == 0;
+    if (pot.ledger.isValid() and not due)
+        ulist = pot.ledger.energies();
+    else {
+        ulist = energyFunc();
+        if (pot.ledger.isValid()) {
+            double u = std::accumulate(ulist.begin(), ulist.end(), 0.0);
+            double deviation = pot.ledger.total() - u;
+            if (std::fabs(deviation) > 1e-6 * std::max(1.0, std::fabs(u)))
+                faunus_logger->warn("{}: running energy deviates by {} kT from full evaluation", name, deviation);
+        }
+        pot.ledger.reset(ulist);
+    }
     double tot = std::accumulate(ulist.begin(), ulist.end(), 0.0);
     if (not std::isinf(tot)) {
         uavg += tot;
         u2avg += tot * tot;
+        observe(tot);
     }
-    f << cnt * steps << sep << tot;
+    f << sampledsteps << sep << tot;
     for (auto u : ulist)
         f << sep << u;
     f << "\n";
@@ -87,7 +176,7 @@ void SystemEnergy::_sample() {
 }
 
 void SystemEnergy::_to_json(json &j) const {
-    j = {{"file", file}, {"init", uinit}, {"final", energyFunc()}};
+    j = {{"file", file}, {"init", uinit}, {"final", energyFunc()}, {"recompute", recompute}};
     if (cnt > 0) {
         j["mean"] = uavg.avg();
         j["Cv/kB"] = u2avg.avg() - std::pow(uavg.avg(), 2);
@@ -99,6 +188,7 @@ void SystemEnergy::_to_json(json &j) const {
 
 void SystemEnergy::_from_json(const json &j) {
     file = MPI::prefix + j.at("file").get<std::string>();
+    recompute = j.value("recompute", 100);
     if (f)
         f.close();
     f.open(file);
@@ -117,10 +207,11 @@ void SystemEnergy::_from_json(const json &j) {
         f << sep << n;
     f << "\n";
 }
-SystemEnergy::SystemEnergy(const json &j, Energy::Hamiltonian &pot) {
+SystemEnergy::SystemEnergy(const json &j, Energy::Hamiltonian &pot) : pot(pot) {
     for (auto i : pot.vec)
         names.push_back(i->name);
     name = "systemenergy";
+    observable = "energy/kT";
     from_json(j);
     energyFunc = [&pot]() {
         Change change;
@@ -198,16 +289,36 @@ SaveState::SaveState(const json &j, Space &spc) {
             }
         };
 
+    else if (suffix == "ckpt") // native binary checkpoint
+        writeFunc = [&spc, this](const std::string &file) {
+            json meta = {{"reactionlist", reactions}};
+            if (this->saverandom) {
+                meta["random-move"] = Move::Movebase::slump;
+                meta["random-global"] = Faunus::random;
+            }
+            FormatCheckpoint::save(file, spc, meta);
+        };
+
     if (writeFunc == nullptr)
         throw std::runtime_error("unknown file extension for '" + file + "'");
 }
 
-PairFunctionBase::PairFunctionBase(const json &j) { from_json(j); }
+PairFunctionBase::PairFunctionBase(const json &j) {
+    from_json(j);
+    mergeable = true;
+}
+
+void PairFunctionBase::_merge(const Analysisbase &other) {
+    auto &o = dynamic_cast<const PairFunctionBase &>(other);
+    hist += o.hist;
+    V += o.V;
+    npairs += o.npairs;
+}
 
 PairFunctionBase::~PairFunctionBase() {
     std::ofstream f(MPI::prefix + file);
     if (f) {
-        double Vr = 1, sum = hist.sumy();
+        double Vr = 1, sum = (rmax < pc::infty && npairs > 0) ? npairs : hist.sumy();
         hist.stream_decorator = [&](std::ostream &o, double r, double N) {
             if (dim == 3)
                 Vr = 4 * pc::pi * std::pow(r, 2) * dr;
@@ -229,10 +340,15 @@ void PairFunctionBase::_to_json(json &j) const {
          {"slicedir", slicedir},    {"thickness", thickness}};
     if (Rhypersphere > 0)
         j["Rhyper"] = Rhypersphere;
+    if (rmax < pc::infty)
+        j["rmax"] = rmax / 1.0_angstrom;
+    if (celllist)
+        j["celllist"] = celllist;
 }
 
 void PairFunctionBase::_from_json(const json &j) {
-    assertKeys(j, {"file", "name1", "name2", "dim", "dr", "Rhyper", "nstep", "nskip", "slicedir", "thickness"});
+    assertKeys(j, {"file", "name1", "name2", "dim", "dr", "Rhyper", "nstep", "nskip", "slicedir", "thickness", "rmax",
+                   "celllist"});
     file = j.at("file");
     name1 = j.at("name1");
     name2 = j.at("name2");
@@ -242,6 +358,68 @@ void PairFunctionBase::_from_json(const json &j) {
     thickness = j.value("thickness", 0);
     hist.setResolution(dr, 0);
     Rhypersphere = j.value("Rhyper", -1.0);
+    rmax = j.value("rmax", pc::infty) * 1.0_angstrom;
+    celllist = j.value("celllist", false);
+    if (celllist && rmax >= pc::infty)
+        throw std::runtime_error("celllist requires rmax");
+    if (rmax < pc::infty && slicedir.sum() > 0)
+        throw std::runtime_error("rmax cannot be combined with slicedir");
+}
+
+void PairFunctionBase::samplePairs(const std::vector<Point> &a, const std::vector<Point> &b,
+                                   const Geometry::Chameleon &geo, bool slice) {
+    const bool same = (&a == &b);
+    const int N = (int)a.size();
+    npairs += same ? 0.5 * N * (N - 1) : double(N) * b.size();
+    const Point slicevec = slicedir.cast<double>();
+
+    // `b` is binned and each point in `a` visits its own and the adjacent cells
+    std::unique_ptr<Geometry::CellList> cells;
+    if (celllist) {
+        cells = std::make_unique<Geometry::CellList>(rmax);
+        cells->update(geo, b);
+    }
+
+    std::vector<double> counts; // merged histogram; bin index is floor(r/dr)
+#pragma omp parallel
+    {
+        std::vector<double> local;
+        auto add = [&](const Point &rvec) {
+            if (slice && slicedir.sum() > 0 && rvec.cwiseProduct(slicevec).norm() >= thickness)
+                return;
+            double r = rvec.norm();
+            if (r < rmax) {
+                size_t bin = size_t(r / dr);
+                if (bin >= local.size())
+                    local.resize(bin + 1, 0.0);
+                local[bin]++;
+            }
+        };
+        geo.dispatch([&](const auto &distance) {
+#pragma omp for schedule(dynamic, 64)
+            for (int i = 0; i < N; i++) {
+                if (cells)
+                    cells->forEachCandidate(a[i], [&](int j) {
+                        if (!same || j > i)
+                            add(distance.vdist(a[i], b[j]));
+                    });
+                else
+                    for (size_t j = same ? i + 1 : 0; j < b.size(); j++)
+                        add(distance.vdist(a[i], b[j]));
+            }
+            return 0;
+        });
+#pragma omp critical
+        {
+            if (local.size() > counts.size())
+                counts.resize(local.size(), 0.0);
+            for (size_t k = 0; k < local.size(); k++)
+                counts[k] += local[k];
+        }
+    }
+    for (size_t k = 0; k < counts.size(); k++)
+        if (counts[k] > 0)
+            hist((k + 0.5) * dr) += counts[k];
 }
 
 PairAngleFunctionBase::PairAngleFunctionBase(const json &j) : PairFunctionBase(j) { from_json(j); }
@@ -260,6 +438,11 @@ PairAngleFunctionBase::~PairAngleFunctionBase() {
 
 void PairAngleFunctionBase::_from_json(const json &) { hist2.setResolution(dr, 0); }
 
+void PairAngleFunctionBase::_merge(const Analysisbase &other) {
+    PairFunctionBase::_merge(other);
+    hist2 += dynamic_cast<const PairAngleFunctionBase &>(other).hist2;
+}
+
 void VirtualVolume::_sample() {
     if (fabs(dV) > 1e-10) {
         // store old volume and energy
@@ -281,6 +464,7 @@ void VirtualVolume::_sample() {
         } else {
             assert(not std::isnan(x));
             duexp += x;
+            observe(x);
 #ifndef NDEBUG
             // check volume and particle positions are properly restored
             double err = std::fabs((Uold - pot.energy(c)) / Uold); // must be ~zero!
@@ -318,6 +502,7 @@ VirtualVolume::VirtualVolume(const json &j, Space &spc, Energy::Energybase &pot)
     c.dV = true;
     c.all = true;
     name = "virtualvolume";
+    observable = "exp(-du/kT)";
     cite = "doi:10.1063/1.472721";
     getVolume = [&spc]() { return spc.geo.getVolume(); };
     scaleVolume = [&spc](double Vnew) { spc.scaleVolume(Vnew); };
@@ -347,24 +532,168 @@ QRtraj::QRtraj(const json &j, Space &spc) {
     };
 }
 
+/**
+ * Snapshots are taken in the MC thread by deep copying particles, groups and geometry
+ * into a recycled `Space` buffer. A single worker swaps each snapshot into the `Space`
+ * that the asynchronous analyses were constructed with and samples them in the order
+ * of the MC steps so that results are identical to synchronous execution. The number
+ * of elapsed steps is passed along with each snapshot to keep the sample counters of
+ * the analyses in step. If all buffers are pending, the MC thread waits.
+ */
+class CombinedAnalysis::Pipeline {
+    struct Item {
+        int steps;                    // MC steps since previous item
+        std::unique_ptr<Space> space; // snapshot; nullptr if no analysis is due
+    };
+    Space &spc;                                // live system
+    std::deque<Item> pending;                  // snapshots waiting for analysis
+    std::vector<std::unique_ptr<Space>> spare; // recycled snapshot buffers
+    std::mutex mutex;
+    std::condition_variable changed; // signalled whenever `pending` or `spare` changes
+    bool busy = false, stop = false;
+    std::exception_ptr error = nullptr; // first exception thrown by the worker
+    int step = 0, steps = 0;            // total MC steps; steps since last snapshot
+    std::thread worker;
+
+    void work(Context context) {
+        context.activate(); // thread local state of the MC thread
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            changed.wait(lock, [&] { return stop or not pending.empty(); });
+            if (pending.empty())
+                return;
+            Item item = std::move(pending.front());
+            pending.pop_front();
+            busy = true;
+            bool failed = (error != nullptr);
+            lock.unlock();
+            std::exception_ptr exception = nullptr;
+            try {
+                if (item.space) {
+                    std::swap(snapshot.p, item.space->p); // groups follow the swapped particle storage
+                    std::swap(snapshot.groups, item.space->groups);
+                    snapshot.geo = item.space->geo;
+                }
+                if (not failed)
+                    for (int i = 0; i < item.steps; i++)
+                        for (auto analysis : analyses)
+                            analysis->sample();
+            } catch (...) {
+                exception = std::current_exception();
+            }
+            lock.lock();
+            if (exception and not error)
+                error = exception;
+            if (item.space)
+                spare.push_back(std::move(item.space));
+            busy = false;
+            changed.notify_all();
+        }
+    }
+
+    void push(std::unique_ptr<Space> space) {
+        std::unique_lock<std::mutex> lock(mutex);
+        pending.push_back({steps, std::move(space)});
+        steps = 0;
+        changed.notify_all();
+    }
+
+    void rethrow() {
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+  public:
+    Space snapshot;                       // system seen by the asynchronous analyses
+    std::vector<Analysisbase *> analyses; // run by the worker thread
+
+    Pipeline(Space &spc, int queue) : spc(spc) {
+        if (queue < 1)
+            throw std::runtime_error("analysis queue must be positive");
+        Change change;
+        change.all = true;
+        snapshot.sync(spc, change);
+        for (int i = 0; i < queue; i++)
+            spare.push_back(std::make_unique<Space>());
+        worker = std::thread(&Pipeline::work, this, Context::current());
+    }
+
+    ~Pipeline() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+            changed.notify_all();
+        }
+        worker.join();
+    }
+
+    void sample() {
+        steps++;
+        step++;
+        if (std::any_of(analyses.begin(), analyses.end(), [&](auto analysis) { return analysis->isDue(step); })) {
+            std::unique_ptr<Space> space;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return not spare.empty(); }); // back-pressure
+                rethrow();
+                space = std::move(spare.back());
+                spare.pop_back();
+            }
+            Change change;
+            change.all = true;
+            space->sync(spc, change);
+            push(std::move(space));
+        }
+    }
+
+    void flush() {
+        if (steps > 0)
+            push(nullptr); // bring sample counters up to date
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return pending.empty() and not busy; });
+        rethrow();
+    }
+};
+
 void CombinedAnalysis::sample() {
-    for (auto &ptr : this->vec)
-        ptr->sample();
+    for (auto analysis : synchronous)
+        analysis->sample();
+    if (pipeline)
+        pipeline->sample();
+}
+
+void CombinedAnalysis::flush() {
+    if (pipeline)
+        pipeline->flush();
 }
 
 CombinedAnalysis::~CombinedAnalysis() {
+    if (pipeline) {
+        try {
+            pipeline->flush();
+        } catch (std::exception &e) {
+            faunus_logger->error("asynchronous analysis: {}", e.what());
+        }
+        pipeline = nullptr;
+    }
     // this is really a hack; the destructor should not be in charge of this
     for (auto &ptr : this->vec)
         ptr->to_disk();
 }
 
-CombinedAnalysis::CombinedAnalysis(const json &j, Space &spc, Energy::Hamiltonian &pot) {
+CombinedAnalysis::CombinedAnalysis(const json &j, Space &live, Energy::Hamiltonian &pot, int queue) {
+    if (queue > 0)
+        pipeline = std::make_unique<Pipeline>(live, queue);
+    const std::set<std::string> synchronous_only = {"sanity", "savestate", "systemenergy", "virtualvolume", "widom"};
     if (j.is_array()) {
         for (auto &m : j) {
             for (auto it = m.begin(); it != m.end(); ++it) {
                 if (it->is_object()) {
                     try {
                         size_t oldsize = this->vec.size();
+                        bool offload = pipeline and synchronous_only.count(it.key()) == 0 and
+                                       not it->value("adaptive", false); // interval changes while sampling
+                        Space &spc = offload ? pipeline->snapshot : live;
                         if (it.key() == "atomprofile")
                             emplace_back<AtomProfile>(it.value(), spc);
                         else if (it.key() == "atomrdf")
@@ -413,6 +742,11 @@ CombinedAnalysis::CombinedAnalysis(const json &j, Space &spc, Energy::Hamiltonia
 
                         if (this->vec.size() == oldsize)
                             throw std::runtime_error("unknown analysis: "s + it.key());
+                        this->vec.back()->validate();
+                        if (offload)
+                            pipeline->analyses.push_back(this->vec.back().get());
+                        else
+                            synchronous.push_back(this->vec.back().get());
 
                     } catch (std::exception &e) {
                         throw std::runtime_error(e.what() + usageTip[it.key()]);
@@ -423,6 +757,146 @@ CombinedAnalysis::CombinedAnalysis(const json &j, Space &spc, Energy::Hamiltonia
     }
 }
 
+LabelledAnalysis::LabelledAnalysis(const json &j, Space &spc, Energy::Hamiltonian &pot, int queue)
+    : input(j), spc(spc), pot(pot), queue(queue) {}
+
+CombinedAnalysis &LabelledAnalysis::operator[](int label) {
+    auto it = labels.find(label);
+    if (it == labels.end()) {
+        auto prefix = MPI::prefix; // output files are named on construction
+        MPI::prefix += LabelledAnalysis::prefix(label);
+        try {
+            it = labels.emplace(label, std::make_shared<CombinedAnalysis>(input, spc, pot, queue)).first;
+        } catch (...) {
+            MPI::prefix = prefix;
+            throw;
+        }
+        MPI::prefix = prefix;
+    }
+    return *it->second;
+}
+
+void LabelledAnalysis::sample(int label) { (*this)[label].sample(); }
+
+std::string LabelledAnalysis::prefix(int label) {
+    return (label < 0) ? std::string() : "label" + std::to_string(label) + ".";
+}
+
+struct TrajectoryRerun::Worker {
+    std::unique_ptr<Space> space_copy;             // nullptr if using the original space
+    std::shared_ptr<Energy::Hamiltonian> pot_copy; // nullptr if using the original Hamiltonian
+    Space &spc;
+    Energy::Hamiltonian &pot;
+    CombinedAnalysis analysis;
+
+    Worker(const json &j, Space &spc, Energy::Hamiltonian &pot) : spc(spc), pot(pot), analysis(j, spc, pot) {}
+
+    Worker(const json &j, std::unique_ptr<Space> space, std::shared_ptr<Energy::Hamiltonian> hamiltonian)
+        : space_copy(std::move(space)), pot_copy(hamiltonian), spc(*space_copy), pot(*pot_copy),
+          analysis(j, spc, pot) {}
+
+    void sample() {
+        for (auto &g : spc.groups) // molecules are made whole relative to their first particle
+            if (not g.empty() and not g.atomic)
+                g.cm = Geometry::massCenter(g.begin(), g.end(), spc.geo.getBoundaryFunc(), -g.begin()->pos);
+        pot.init();             // update energy terms that depend on the whole configuration
+        pot.ledger.invalidate(); // running energy does not follow the trajectory
+        analysis.sample();
+    }
+};
+
+TrajectoryRerun::TrajectoryRerun(const json &j, Space &spc, Energy::Hamiltonian &pot, int threads) {
+    json input = j; // each frame is sampled once by all enabled analyses
+    if (input.is_array())
+        for (auto &m : input)
+            for (auto &i : m)
+                if (i.is_object()) {
+                    if (i.value("nstep", 0) > 0)
+                        i["nstep"] = 1;
+                    i.erase("nskip");
+                    i.erase("adaptive");
+                }
+
+    workers.push_back(std::make_unique<Worker>(input, spc, pot));
+    auto &analyses = workers.front()->analysis;
+    bool mergeable = std::all_of(analyses.begin(), analyses.end(), [](auto &i) { return i->mergeable; });
+    if (threads < 1)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    if (threads > 1 and not mergeable) {
+        faunus_logger->warn("rerun uses a single thread as not all analyses can be merged");
+        threads = 1;
+    }
+    Change change;
+    change.all = true;
+    for (int i = 1; i < threads; i++) {
+        auto space = std::make_unique<Space>();
+        space->sync(spc, change);
+        std::shared_ptr<Energy::Hamiltonian> hamiltonian;
+        try {
+            hamiltonian = pot.replica(*space);
+        } catch (std::exception &e) {
+            faunus_logger->warn("rerun uses a single thread: {}", e.what());
+            break;
+        }
+        workers.push_back(std::make_unique<Worker>(input, std::move(space), hamiltonian));
+    }
+}
+
+TrajectoryRerun::~TrajectoryRerun() = default;
+
+CombinedAnalysis &TrajectoryRerun::analysis() { return workers.front()->analysis; }
+
+size_t TrajectoryRerun::run(const std::string &file) {
+    FormatXTC xtc(1e6);
+    if (not xtc.open(file))
+        throw std::runtime_error("cannot open trajectory " + file);
+
+    std::mutex mutex; // guards the trajectory and the variables below
+    size_t frames = 0;
+    bool done = false;
+    std::exception_ptr error = nullptr;
+
+    auto work = [&](Worker &worker, const Context &context) {
+        context.activate(); // thread local state of the calling thread
+        try {
+            while (true) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (done or not xtc.loadnextframe(worker.spc)) { // frames are read in turn...
+                        done = true;
+                        return;
+                    }
+                    frames++;
+                }
+                worker.sample(); // ...but analysed concurrently
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (not error)
+                error = std::current_exception();
+            done = true;
+        }
+    };
+
+    // the first worker continues the random numbers of the calling thread; the others get independent streams
+    std::vector<std::thread> threads;
+    const Context context = Context::current();
+    for (size_t i = 0; i < workers.size(); i++)
+        threads.emplace_back(work, std::ref(*workers[i]), (i == 0) ? context : context.stream(i));
+    for (auto &thread : threads)
+        thread.join();
+    if (error)
+        std::rethrow_exception(error);
+
+    // merge samples into the first worker; the others are destroyed
+    // before the first so that their output files are overwritten
+    for (size_t i = 1; i < workers.size(); i++)
+        for (size_t k = 0; k < analysis().size(); k++)
+            analysis().at(k)->merge(*workers[i]->analysis.at(k));
+    workers.resize(1);
+    return frames;
+}
+
 void FileReactionCoordinate::_to_json(json &j) const {
     json rcjson = *rc; // envoke to_json(...)
     if (rcjson.count(type) == 0)
@@ -440,7 +914,8 @@ void FileReactionCoordinate::_sample() {
     if (file) {
         double val = (*rc)();
         avg += val;
-        file << cnt * steps << " " << val << " " << avg.avg() << "\n";
+        observe(val);
+        file << sampledsteps << " " << val << " " << avg.avg() << "\n";
     }
 }
 
@@ -450,18 +925,34 @@ FileReactionCoordinate::FileReactionCoordinate(const json &j, Space &spc) {
     filename = MPI::prefix + j.at("file").get<std::string>();
     file.open(filename); // output file
     type = j.at("type").get<std::string>();
+    observable = type;
     rc = ReactionCoordinate::createReactionCoordinate({{type, j}}, spc);
 }
 
+void WidomInsertion::updateCavities() {
+    if (rins.cavities) {
+        std::vector<Point> positions;
+        for (auto &i : spc.activeParticles())
+            positions.push_back(i.pos);
+        rins.cavities->update(spc.geo, positions);
+        cavity_fraction += rins.cavities->fraction();
+    }
+}
+
 void WidomInsertion::_sample() {
-    if (!change.empty()) {
+    updateCavities();
+    if (threads > 1 and not change.empty())
+        sampleParallel();
+    else if (!change.empty()) {
         ParticleVector pin;
         auto &g = spc.groups.at(change.groups.at(0).index);
         assert(g.empty() && g.capacity() > 0);
         g.resize(g.capacity()); // active group
         for (int i = 0; i < ninsert; ++i) {
             pin = rins(spc.geo, spc.p, molecules.at(molid));
-            if (not pin.empty()) {
+            if (pin.empty() and rins.cavities) // no cavities
+                expu += 0;
+            else if (not pin.empty()) {
                 if (absolute_z) {
                     for (auto &p : pin)
                         p.pos.z() = std::fabs(p.pos.z());
@@ -473,13 +964,64 @@ void WidomInsertion::_sample() {
                 if (not g.atomic)                             // update molecular mass-center
                     g.cm = Geometry::massCenter(g.begin(), g.end(), spc.geo.getBoundaryFunc(), -g.begin()->pos);
 
-                expu += exp(-pot->energy(change)); // widom average
+                expu += exp(-pot->energy(change) + rins.lnbias); // widom average
             }
         }
         g.resize(0); // deactive molecule
     }
 }
 
+void WidomInsertion::sampleParallel() {
+    std::vector<ParticleVector> trials; // serially generated insertions
+    std::vector<double> lnbias;         // cavity bias of each insertion
+    trials.reserve(ninsert);
+    for (int i = 0; i < ninsert; ++i) {
+        ParticleVector pin = rins(spc.geo, spc.p, molecules.at(molid));
+        if (pin.empty() and rins.cavities) // no cavities
+            expu += 0;
+        else if (not pin.empty()) {
+            if (absolute_z)
+                for (auto &p : pin)
+                    p.pos.z() = std::fabs(p.pos.z());
+            trials.push_back(pin);
+            lnbias.push_back(rins.lnbias);
+        }
+    }
+
+    Change all;
+    all.all = true;
+    if (replicas.empty())
+        for (int i = 0; i < threads; i++) {
+            auto replica = std::make_shared<Replica>();
+            replica->spc.sync(spc, all);
+            replica->pot = pot->replica(replica->spc);
+            replica->pot->init();
+            replicas.push_back(replica);
+        }
+
+    std::vector<double> boltzmann(trials.size());
+#pragma omp parallel for schedule(static) num_threads(threads)
+    for (size_t k = 0; k < replicas.size(); k++) {
+        auto &replica = *replicas[k];
+        replica.spc.sync(spc, all);  // copy current configuration
+        replica.pot->copyState(*pot); // copy energy state without re-initialising
+        Change c = change;
+        auto &g = replica.spc.groups.at(c.groups.at(0).index);
+        assert(g.empty() && g.capacity() > 0);
+        g.resize(g.capacity()); // active group
+        for (size_t i = k * trials.size() / replicas.size(); i < (k + 1) * trials.size() / replicas.size(); i++) {
+            assert(trials[i].size() == g.size());
+            std::copy(trials[i].begin(), trials[i].end(), g.begin()); // copy into ghost group
+            if (not g.atomic) // update molecular mass-center
+                g.cm = Geometry::massCenter(g.begin(), g.end(), replica.spc.geo.getBoundaryFunc(), -g.begin()->pos);
+            boltzmann[i] = exp(-replica.pot->energy(c) + lnbias[i]);
+        }
+        g.resize(0); // deactive molecule
+    }
+    for (auto x : boltzmann) // widom average in the same order as serial insertion
+        expu += x;
+}
+
 void WidomInsertion::_to_json(json &j) const {
     double excess = -std::log(expu.avg());
     j = {{"dir", rins.dir},
@@ -487,12 +1029,26 @@ void WidomInsertion::_to_json(json &j) const {
          {"insertions", expu.cnt},
          {"absz", absolute_z},
          {u8::mu + "/kT", {{"excess", excess}}}};
+    if (threads > 1)
+        j["threads"] = threads;
+    if (rins.cavities)
+        j["cavity"] = {{"radius", rins.cavities->radius},
+                       {"spacing", rins.cavities->spacing},
+                       {"fraction", cavity_fraction.avg()}};
 }
 
 void WidomInsertion::_from_json(const json &j) {
     ninsert = j.at("ninsert");
     molname = j.at("molecule");
     absolute_z = j.value("absz", false);
+    threads = j.value("threads", 1);
+    if (threads < 1)
+        throw std::runtime_error(name + ": threads must be positive");
+    if (j.count("cavity") == 1) {
+        if (absolute_z)
+            throw std::runtime_error(name + ": absz cannot be used with cavity-biased insertion");
+        rins.cavities = RandomInserter::makeCavities(j.at("cavity"));
+    }
     rins.dir = j.value("dir", Point({1, 1, 1}));
 
     auto it = findName(molecules, molname); // loop for molecule in topology
@@ -538,6 +1094,7 @@ void Density::_sample() {
 
     double V = spc.geo.getVolume();
     Vavg += V;
+    observe(V);
     Lavg += std::cbrt(V);
     invVavg += 1 / V;
 
@@ -589,9 +1146,32 @@ void Density::_to_json(json &j) const {
             _jj[molecules.at(i.first).name] = json({{"c/M", i.second.avg() / 1.0_molar}});
     _roundjson(j, 4);
 }
+void Density::_merge(const Analysisbase &other) {
+    auto &o = dynamic_cast<const Density &>(other);
+    auto add = [](auto &dst, const auto &src) {
+        for (auto &i : src) {
+            auto it = dst.find(i.first);
+            if (it == dst.end())
+                dst.insert(i);
+            else
+                it->second += i.second;
+        }
+    };
+    add(swpdhist, o.swpdhist);
+    add(atmdhist, o.atmdhist);
+    add(moldhist, o.moldhist);
+    add(rho_mol, o.rho_mol);
+    add(rho_atom, o.rho_atom);
+    Lavg += o.Lavg;
+    Vavg += o.Vavg;
+    invVavg += o.invVavg;
+}
+
 Density::Density(const json &j, Space &spc) : spc(spc) {
     from_json(j);
     name = "density";
+    observable = "volume/" + u8::angstrom + u8::cubed;
+    mergeable = true;
     for (auto &m : molecules) {
         if (m.atomic)
             atmdhist[m.id()].setResolution(1, 0);
@@ -706,20 +1286,15 @@ SanityCheck::SanityCheck(const json &j, Space &spc) : spc(spc) {
 }
 void AtomRDF::_sample() {
     V += spc.geo.getVolume(dim);
-    auto active = spc.activeParticles();
-    for (auto i = active.begin(); i != active.end(); ++i)
-        for (auto j = i; ++j != active.end();)
-            if ((i->id == id1 && j->id == id2) || (i->id == id2 && j->id == id1)) {
-                Point rvec = spc.geo.vdist(i->pos, j->pos);
-                if (slicedir.sum() > 0) {
-                    if (rvec.cwiseProduct(slicedir.cast<double>()).norm() < thickness) {
-                        // rvec = rvec.cwiseProduct( Point(1.,1.,1.) - slice.cast<double>() );
-                        hist(rvec.norm())++;
-                    }
-                } else {
-                    hist(rvec.norm())++;
-                }
-            }
+    positions1.clear();
+    positions2.clear();
+    for (auto &g : spc.groups) // sort active positions by atom type
+        for (auto &i : g)
+            if (i.id == id1)
+                positions1.push_back(i.pos);
+            else if (i.id == id2)
+                positions2.push_back(i.pos);
+    samplePairs(positions1, (id1 == id2) ? positions1 : positions2, spc.geo, true);
 }
 AtomRDF::AtomRDF(const json &j, Space &spc) : PairFunctionBase(j), spc(spc) {
     name = "atomrdf";
@@ -735,17 +1310,14 @@ AtomRDF::AtomRDF(const json &j, Space &spc) : PairFunctionBase(j), spc(spc) {
 }
 void MoleculeRDF::_sample() {
     V += spc.geo.getVolume(dim);
-    auto mollist1 = spc.findMolecules(id1, Space::ACTIVE);
-    auto mollist2 = spc.findMolecules(id2, Space::ACTIVE);
-    auto mollist = ranges::view::concat(mollist1, mollist2);
-    for (auto i = mollist.begin(); i != mollist.end(); ++i) {
-        for (auto j = i; ++j != mollist.end();) {
-            if ((i->id == id1 && j->id == id2) || (i->id == id2 && j->id == id1)) {
-                double r = std::sqrt(spc.geo.sqdist(i->cm, j->cm));
-                hist(r)++;
-            }
-        }
-    }
+    positions1.clear();
+    positions2.clear();
+    for (auto &g : spc.findMolecules(id1, Space::ACTIVE))
+        positions1.push_back(g.cm);
+    if (id1 != id2)
+        for (auto &g : spc.findMolecules(id2, Space::ACTIVE))
+            positions2.push_back(g.cm);
+    samplePairs(positions1, (id1 == id2) ? positions1 : positions2, spc.geo);
 }
 MoleculeRDF::MoleculeRDF(const json &j, Space &spc) : PairFunctionBase(j), spc(spc) {
     name = "molrdf";
@@ -792,6 +1364,8 @@ void AtomDipDipCorr::_sample() {
 }
 AtomDipDipCorr::AtomDipDipCorr(const json &j, Space &spc) : PairAngleFunctionBase(j), spc(spc) {
     name = "atomdipdipcorr";
+    if (j.count("rmax") or j.count("celllist")) // all pairs are sampled, see `_sample()`
+        throw std::runtime_error(name + ": rmax and celllist are not supported");
     auto it = findName(atoms, name1);
     if (it == atoms.end())
         throw std::runtime_error("unknown atom '" + name1 + "'");
@@ -805,52 +1379,63 @@ AtomDipDipCorr::AtomDipDipCorr(const json &j, Space &spc) : PairAngleFunctionBas
 
 // =============== XTCtraj ===============
 
-XTCtraj::XTCtraj(const json &j, Space &s) : filter([](Particle &) { return true; }), xtc(1e6), spc(s) {
+XTCtraj::XTCtraj(const json &j, Space &s) : xtc(1e6), spc(s) {
     from_json(j);
     name = "xtcfile";
-    assert(filter); // filter must be callable
+    if (queue > 0)
+        writer = std::make_unique<XTCWriter>(file, queue);
 }
 
 void XTCtraj::_to_json(json &j) const {
     j["file"] = file;
+    j["queue"] = queue;
     if (not names.empty())
         j["molecules"] = names;
 }
 
 void XTCtraj::_from_json(const json &j) {
     file = MPI::prefix + j.at("file").get<std::string>();
+    queue = j.value("queue", 2);
+    if (queue < 0)
+        throw std::runtime_error("queue must be zero or positive");
 
     // By default, *all* active and inactive groups are saved,
     // but here allow for a user defined list of molecule ids
     names = j.value("molecules", std::vector<std::string>());
-    if (not names.empty()) {
+    if (not names.empty())
         molids = Faunus::names2ids(Faunus::molecules, names); // molecule types to save
-        if (not molids.empty())
-            filter = [&](Particle &i) {
-                for (auto &g : spc.groups)     // loop over all active and inactive groups
-                    if (g.contains(i, true)) { // does group contain particle?
-                        if (std::find(molids.begin(), molids.end(), g.id) != molids.end())
-                            return true;
-                        else
-                            return false;
-                    }
-                return false;
-            };
-    };
+}
+
+void XTCtraj::pack(std::vector<float> &x) const {
+    x.clear();
+    Point box = spc.geo.getLength();
+    if (molids.empty())
+        FormatXTC::pack(spc.p.begin(), spc.p.end(), box, x);
+    else
+        for (auto &g : spc.groups) // groups are stored contiguously, in particle order
+            if (std::find(molids.begin(), molids.end(), g.id) != molids.end())
+                FormatXTC::pack(g.begin(), g.trueend(), box, x); // active and inactive particles
 }
 
 void XTCtraj::_sample() {
-    xtc.setbox(spc.geo.getLength()); // set box dimensions for frame
+    if (writer)
+        writer->push(spc.geo.getLength(), [&](std::vector<float> &x) { pack(x); });
+    else {
+        xtc.setbox(spc.geo.getLength()); // set box dimensions for frame
+        pack(buffer);
+        if (not xtc.write(file, buffer))
+            faunus_logger->warn("error saving xtc");
+    }
+}
 
-    // On some gcc/clang and certain ubuntu/macos combinations,
-    // the ranges::view::filter(rng,unaryp) clears the `filter` function.
-    // Using the ranges piping seem to solve the issue.
-    assert(filter);
-    auto particles = spc.p | ranges::view::filter(filter);
-    assert(filter);
-    bool rc = xtc.save(file, particles.begin(), particles.end());
-    if (rc == false)
-        faunus_logger->warn("error saving xtc");
+void XTCtraj::_to_disk() {
+    if (writer) {
+        try {
+            writer->flush();
+        } catch (std::exception &e) {
+            faunus_logger->error("{}: {}", name, e.what());
+        }
+    }
 }
 
 // =============== MultipoleDistribution ===============
@@ -881,29 +1466,87 @@ void MultipoleDistribution::save() const {
         }
     }
 }
+/**
+ * Multipoles are calculated once for each group and the pairs are shared between threads,
+ * each accumulating to its own table. With `celllist`, only pairs in the same or
+ * adjacent cells of a mass center cell list are visited.
+ */
 void MultipoleDistribution::_sample() {
-    for (auto &gi : spc.findMolecules(ids[0]))     // find active molecules
-        for (auto &gj : spc.findMolecules(ids[1])) // find active molecules
-            if (gi != gj) {
-                auto a = Faunus::toMultipole(gi, spc.geo.getBoundaryFunc());
-                auto b = Faunus::toMultipole(gj, spc.geo.getBoundaryFunc());
-                Point R = spc.geo.vdist(gi.cm, gj.cm);
-                auto &d = m[to_bin(R.norm(), dr)];
-                d.tot += g2g(gi, gj);
-                d.ii += a.charge * b.charge / R.norm();
-                d.id += q2mu(a.charge * b.getExt().mulen, b.getExt().mu, b.charge * a.getExt().mulen, a.getExt().mu, R);
-                d.dd += mu2mu(a.getExt().mu, b.getExt().mu, a.getExt().mulen * b.getExt().mulen, R);
-                d.iq += q2quad(a.charge, b.getExt().Q, b.charge, a.getExt().Q, R);
-                d.mucorr += a.getExt().mu.dot(b.getExt().mu);
+    std::vector<const Tgroup *> groups1, groups2; // active molecules
+    std::vector<Particle> multipoles1, multipoles2;
+    std::vector<Point> positions2;
+    for (auto &g : spc.findMolecules(ids[0])) {
+        groups1.push_back(&g);
+        multipoles1.push_back(Faunus::toMultipole(g, spc.geo.getBoundaryFunc()));
+    }
+    for (auto &g : spc.findMolecules(ids[1])) {
+        groups2.push_back(&g);
+        multipoles2.push_back(Faunus::toMultipole(g, spc.geo.getBoundaryFunc()));
+        positions2.push_back(g.cm);
+    }
+
+    std::unique_ptr<Geometry::CellList> cells;
+    if (celllist) {
+        cells = std::make_unique<Geometry::CellList>(rmax);
+        cells->update(spc.geo, positions2);
+    }
+
+#pragma omp parallel
+    {
+        std::map<int, data> local;
+        auto add = [&](int i, int j) {
+            if (groups1[i] != groups2[j]) {
+                Point R = spc.geo.vdist(groups1[i]->cm, groups2[j]->cm);
+                if (R.norm() < rmax) {
+                    auto &a = multipoles1[i];
+                    auto &b = multipoles2[j];
+                    auto &d = local[to_bin(R.norm(), dr)];
+                    d.tot += g2g(*groups1[i], *groups2[j]);
+                    d.ii += a.charge * b.charge / R.norm();
+                    d.id += q2mu(a.charge * b.getExt().mulen, b.getExt().mu, b.charge * a.getExt().mulen,
+                                 a.getExt().mu, R);
+                    d.dd += mu2mu(a.getExt().mu, b.getExt().mu, a.getExt().mulen * b.getExt().mulen, R);
+                    d.iq += q2quad(a.charge, b.getExt().Q, b.charge, a.getExt().Q, R);
+                    d.mucorr += a.getExt().mu.dot(b.getExt().mu);
+                }
             }
+        };
+#pragma omp for schedule(dynamic)
+        for (int i = 0; i < (int)groups1.size(); i++) {
+            if (cells)
+                cells->forEachCandidate(groups1[i]->cm, [&](int j) { add(i, j); });
+            else
+                for (int j = 0; j < (int)groups2.size(); j++)
+                    add(i, j);
+        }
+#pragma omp critical
+        for (auto &i : local)
+            m[i.first] += i.second;
+    }
 }
 
-void MultipoleDistribution::_to_json(json &j) const { j = {{"molecules", names}, {"file", filename}, {"dr", dr}}; }
+void MultipoleDistribution::_to_json(json &j) const {
+    j = {{"molecules", names}, {"file", filename}, {"dr", dr}};
+    if (rmax < pc::infty)
+        j["rmax"] = rmax / 1.0_angstrom;
+    if (celllist)
+        j["celllist"] = celllist;
+}
+
+void MultipoleDistribution::_merge(const Analysisbase &other) {
+    for (auto &i : dynamic_cast<const MultipoleDistribution &>(other).m)
+        m[i.first] += i.second;
+}
 
 MultipoleDistribution::MultipoleDistribution(const json &j, Space &spc) : spc(spc) {
     from_json(j);
     name = "Multipole Distribution";
+    mergeable = true;
     dr = j.value("dr", 0.2);
+    rmax = j.value("rmax", pc::infty) * 1.0_angstrom;
+    celllist = j.value("celllist", false);
+    if (celllist && rmax >= pc::infty)
+        throw std::runtime_error("celllist requires rmax");
     filename = j.at("file").get<std::string>();
     names = j.at("molecules").get<decltype(names)>(); // molecule names
     ids = names2ids(molecules, names);                // names --> molids
@@ -927,7 +1570,7 @@ Point AtomInertia::compute() {
 }
 void AtomInertia::_sample() {
     if (file)
-        file << cnt * steps << " " << compute().transpose() << "\n";
+        file << sampledsteps << " " << compute().transpose() << "\n";
 }
 AtomInertia::AtomInertia(const json &j, Space &spc) : spc(spc) {
     from_json(j);
@@ -957,7 +1600,7 @@ InertiaTensor::Data InertiaTensor::compute() {
 void InertiaTensor::_sample() {
     InertiaTensor::Data d = compute();
     if (file)
-        file << cnt * steps << " " << d.eivals.transpose() << " " << d.eivec.transpose() << "\n";
+        file << sampledsteps << " " << d.eivals.transpose() << " " << d.eivec.transpose() << "\n";
 }
 InertiaTensor::InertiaTensor(const json &j, Space &spc) : spc(spc) {
     from_json(j);
@@ -1005,7 +1648,7 @@ MultipoleMoments::Data MultipoleMoments::compute() {
 void MultipoleMoments::_sample() {
     MultipoleMoments::Data d = compute();
     if (file) 
-        file << cnt * steps << " " << d.q << " " << d.mu.transpose() << " " << d.center.transpose() << " "
+        file << sampledsteps << " " << d.q << " " << d.mu.transpose() << " " << d.center.transpose() << " "
              << d.eivals.transpose() << " " << d.eivec.transpose() << "\n";
 }
 MultipoleMoments::MultipoleMoments(const json &j, Space &spc) : spc(spc) {
@@ -1113,7 +1756,11 @@ void AtomProfile::_sample() {
 AtomProfile::AtomProfile(const json &j, Space &spc) : spc(spc) {
     name = "atomprofile";
     from_json(j);
+    mergeable = true;
 }
+
+void AtomProfile::_merge(const Analysisbase &other) { tbl += dynamic_cast<const AtomProfile &>(other).tbl; }
+
 void AtomProfile::_to_disk() {
     std::ofstream f(MPI::prefix + file);
     if (f) {
@@ -1269,9 +1916,19 @@ void Multipole::_to_json(json &j) const {
                                       {u8::mu, d.second.mu.avg()},
                                       {u8::mu + u8::squared, d.second.mu2.avg()}};
 }
+void Multipole::_merge(const Analysisbase &other) {
+    for (auto &i : dynamic_cast<const Multipole &>(other)._map) {
+        auto &d = _map[i.first];
+        d.Z += i.second.Z;
+        d.Z2 += i.second.Z2;
+        d.mu += i.second.mu;
+        d.mu2 += i.second.mu2;
+    }
+}
 Multipole::Multipole(const json &j, const Space &spc) : spc(spc) {
     from_json(j);
     name = "multipole";
+    mergeable = true;
 }
 void ScatteringFunction::_sample() {
     p.clear();
@@ -1284,22 +1941,39 @@ void ScatteringFunction::_sample() {
                 for (auto &i : g) // loop over particle index in group
                     p.push_back(i.pos);
     }
-    debye.sample(p, spc.geo.getVolume());
+    if (explicit_q)
+        explicit_q->sample(p, spc.geo.getLength());
+    else
+        debye.sample(p, spc.geo.getVolume());
+}
+void ScatteringFunction::_to_json(json &j) const {
+    j = {{"molecules", names}, {"com", usecom}, {"scheme", explicit_q ? "explicit" : "debye"}};
 }
-void ScatteringFunction::_to_json(json &j) const { j = {{"molecules", names}, {"com", usecom}}; }
 
-ScatteringFunction::ScatteringFunction(const json &j, Space &spc) try : spc(spc), debye(j) {
+ScatteringFunction::ScatteringFunction(const json &j, Space &spc) try
+    : spc(spc), debye(j.value("scheme", "debye") == "explicit" ? json({{"qmin", 1}, {"qmax", 1}, {"dq", 1}})
+                                                               : j) { // q range is unused for explicit q vectors
     from_json(j);
     name = "scatter";
     usecom = j.value("com", true);
     filename = j.at("file").get<std::string>();
     names = j.at("molecules").get<decltype(names)>(); // molecule names
     ids = names2ids(molecules, names);                // names --> molids
+    std::string scheme = j.value("scheme", "debye");
+    if (scheme == "explicit")
+        explicit_q = std::make_shared<Scatter::StructureFactorPBC<double>>(j.value("pmax", 15));
+    else if (scheme != "debye")
+        throw std::runtime_error("unknown scheme: " + scheme);
 } catch (std::exception &e) {
     throw std::runtime_error("debye formula: "s + e.what());
 }
 
-ScatteringFunction::~ScatteringFunction() { debye.save(filename); }
+ScatteringFunction::~ScatteringFunction() {
+    if (explicit_q)
+        explicit_q->save(filename);
+    else
+        debye.save(filename);
+}
 
 } // namespace Analysis
 } // namespace Faunus
@@ -31,23 +31,37 @@ class Analysisbase {
     virtual void _from_json(const json &);
     virtual void _sample() = 0;
     virtual void _to_disk(); //!< save data to disk
+    virtual void _merge(const Analysisbase &); //!< add samples from another instance of same type
     int stepcnt = 0;
     int totstepcnt = 0;
     TimeRelativeOfTotal<std::chrono::microseconds> timer;
+    BlockAverage<double> blocks; //!< all values passed to `observe()`
+    BlockAverage<double> window; //!< values since the sample interval was last adjusted
+    bool adaptive = false;       //!< stretch sample interval to the correlation time of the observable
+    bool merged = false;         //!< true if samples of other instances were merged; `blocks` is then unused
+    int maxsteps = 0;            //!< upper limit for adaptive sample interval
+    void adapt();                //!< adjust sample interval to the correlation time in `window`
 
   protected:
     int steps = 0; //!< Sample interval (do not modify)
     int nskip = 0; //!< MC steps to skip before sampling
     int cnt = 0;   //!< number of samples
+    int sampledsteps = 0; //!< Sum of sample intervals at each sample, i.e. `cnt*steps` for a fixed interval
+    std::string observable; //!< Name of scalar passed to `observe()`
+    void observe(double x); //!< Add scalar used for error estimation and adaptive sampling
 
   public:
     std::string name; //!< descriptive name
     std::string cite; //!< url, doi etc. describing the analysis
+    bool mergeable = false; //!< true if samples from several instances can be combined with `merge()`
 
     void to_json(json &) const;    //!< JSON report w. statistics, output etc.
     void from_json(const json &);  //!< configure from json object
     void to_disk();                //!< Save data to disk (if defined)
     virtual void sample();
+    bool isDue(int step) const; //!< True if `sample()` samples at the given (1-based) step
+    void merge(const Analysisbase &other); //!< Add samples from an identically configured analysis
+    void validate() const; //!< Throw if settings do not apply to the derived analysis; call after construction
     virtual ~Analysisbase() = default;
 };
 
@@ -72,19 +86,36 @@ class FileReactionCoordinate : public Analysisbase {
 
 /**
  * @brief Excess chemical potential of molecules
+ *
+ * With `threads` larger than one, insertions are evaluated concurrently using a
+ * replica of the space and Hamiltonian for each thread. Trial positions are generated
+ * serially so that the result is independent of the number of threads.
+ * If `cavity` is given, insertions are restricted to cavities and the Boltzmann factors
+ * are weighted by the cavity volume fraction.
  */
 class WidomInsertion : public Analysisbase {
+    struct Replica {
+        Space spc;
+        std::shared_ptr<Energy::Hamiltonian> pot;
+    }; //!< Space and Hamiltonian used by a single thread
+
     Space &spc;
     Energy::Hamiltonian *pot;
     RandomInserter rins;
     std::string molname; // molecule name
     int ninsert;
     int molid; // molecule id
+    int threads = 1;
     bool absolute_z = false;
     Average<double> expu;
+    Average<double> cavity_fraction; // volume fraction available for cavity-biased insertion
     Change change;
+    std::vector<std::shared_ptr<Replica>> replicas;
+
+    void updateCavities(); //!< Find cavities in current configuration for cavity-biased insertion
 
     void _sample() override;
+    void sampleParallel(); //!< Evaluate insertions concurrently on replicas
     void _to_json(json &j) const override;
     void _from_json(const json &j) override;
 
@@ -115,6 +146,7 @@ class AtomProfile : public Analysisbase {
     void _to_json(json &j) const override;
     void _to_disk() override;
     void _sample() override;
+    void _merge(const Analysisbase &) override;
 
   public:
     AtomProfile(const json &j, Space &spc);
@@ -160,6 +192,7 @@ class Density : public Analysisbase {
 
     void _sample() override;
     void _to_json(json &) const override;
+    void _merge(const Analysisbase &) override;
 
   public:
     Density(const json &, Space &);
@@ -198,6 +231,7 @@ class Multipole : public Analysisbase {
 
     void _sample() override;
     void _to_json(json &) const override;
+    void _merge(const Analysisbase &) override;
 
   public:
     Multipole(const json &, const Space &);
@@ -206,7 +240,9 @@ class Multipole : public Analysisbase {
 class SystemEnergy : public Analysisbase {
     std::string file, sep = " ";
     std::ofstream f;
-    std::function<std::vector<double>()> energyFunc;
+    Energy::Hamiltonian &pot;
+    std::function<std::vector<double>()> energyFunc; // full evaluation of all terms
+    int recompute = 100; // samples between full evaluations when using the running energy (0 = never)
     Average<double> uavg, u2avg; //!< mean energy and mean squared energy
     std::vector<std::string> names;
     Table2D<double, double> ehist; // Density histograms
@@ -261,6 +297,21 @@ class PairFunctionBase : public Analysisbase {
     std::string file;         // output filename
     double Rhypersphere = -1; // Radius of 2D hypersphere
     Average<double> V;        // average volume (angstrom^3)
+    double rmax = pc::infty;  // ignore distances beyond this (angstrom)
+    bool celllist = false;    // use cell list to find pairs within `rmax`?
+    double npairs = 0;        // number of pairs visited by `samplePairs()`, including those beyond `rmax`
+
+    /**
+     * @brief Add distances between all pairs of points in `a` and `b` to `hist`
+     *
+     * If `a` and `b` are the same object, each pair is counted once. The loop is
+     * OpenMP parallel with thread local histograms and if `celllist` is set, only
+     * neighbouring cells with side length `rmax` are visited.
+     */
+    void samplePairs(const std::vector<Point> &a, const std::vector<Point> &b, const Geometry::Chameleon &geo,
+                     bool slice = false);
+
+    void _merge(const Analysisbase &) override;
 
   private:
     void _from_json(const json &) override;
@@ -275,6 +326,8 @@ class PairAngleFunctionBase : public PairFunctionBase {
   protected:
     Equidistant2DTable<double, Average<double>> hist2;
 
+    void _merge(const Analysisbase &) override;
+
   private:
     void _from_json(const json &);
 
@@ -286,6 +339,7 @@ class PairAngleFunctionBase : public PairFunctionBase {
 /** @brief Atomic radial distribution function, g(r) */
 class AtomRDF : public PairFunctionBase {
     Space &spc;
+    std::vector<Point> positions1, positions2; // active positions of atom type 1 and 2
 
     void _sample() override;
 
@@ -296,6 +350,7 @@ class AtomRDF : public PairFunctionBase {
 /** @brief Same as `AtomRDF` but for molecules. Identical input. */
 class MoleculeRDF : public PairFunctionBase {
     Space &spc;
+    std::vector<Point> positions1, positions2; // mass centers of active molecules 1 and 2
     void _sample() override;
   public:
     MoleculeRDF(const json &, Space &);
@@ -313,16 +368,20 @@ class AtomDipDipCorr : public PairAngleFunctionBase {
 class XTCtraj : public Analysisbase {
     std::vector<int> molids;        // molecule ids to save to disk
     std::vector<std::string> names; // molecule names of above
-    std::function<bool(Particle &)> filter; // function to filter molecule ids
+    int queue = 2;                  // frames in flight to the background writer (0 = write directly)
 
     void _to_json(json &) const override;
     void _from_json(const json &) override;
 
     FormatXTC xtc;
+    std::unique_ptr<XTCWriter> writer; // background writer if `queue>0`
+    std::vector<float> buffer;         // packed coordinates for direct writing
     Space &spc;
     std::string file;
 
+    void pack(std::vector<float> &x) const; //!< Pack positions of selected molecules
     void _sample() override;
+    void _to_disk() override; //!< Wait for the background writer
 
   public:
     XTCtraj(const json &j, Space &s);
@@ -359,6 +418,16 @@ class MultipoleDistribution : public Analysisbase {
 
     struct data {
         Average<double> tot, ii, id, iq, dd, mucorr;
+
+        data &operator+=(const data &other) {
+            tot += other.tot;
+            ii += other.ii;
+            id += other.id;
+            iq += other.iq;
+            dd += other.dd;
+            mucorr += other.mucorr;
+            return *this;
+        } //!< Merge samples
     };
 
     std::vector<std::string> names; //!< Molecule names (len=2)
@@ -366,6 +435,8 @@ class MultipoleDistribution : public Analysisbase {
     std::string filename;           //!< output file name
     // int id1, id2;                   //!< pair of molecular id's to analyse
     double dr;             //!< distance resolution
+    double rmax;           //!< maximum mass center separation
+    bool celllist;         //!< use cell list of mass centers to find pairs within `rmax`
     std::map<int, data> m; //!< Energy distributions
     Space &spc;
 
@@ -373,6 +444,7 @@ class MultipoleDistribution : public Analysisbase {
     void save() const;                              //!< save to disk
     void _sample() override;
     void _to_json(json &j) const override;
+    void _merge(const Analysisbase &other) override;
 
   public:
     MultipoleDistribution(const json &j, Space &spc);
@@ -390,6 +462,7 @@ class ScatteringFunction : public Analysisbase {
     std::vector<std::string> names; // Molecule names
     typedef Scatter::FormFactorUnity<double> Tformfactor;
     Scatter::DebyeFormula<Tformfactor> debye;
+    std::shared_ptr<Scatter::StructureFactorPBC<double>> explicit_q; // set only for explicit q vectors
 
     void _sample() override;
     void _to_json(json &j) const override;
@@ -502,11 +575,77 @@ class QRtraj : public Analysisbase {
     QRtraj(const json &j, Space &spc);
 };
 
+/**
+ * @brief Aggregates analysis
+ *
+ * If `queue` is positive, analyses that depend on the configuration only are run by a
+ * background thread on snapshots of the system, taken whenever one of them is due, while
+ * the Markov chain continues. At most `queue` snapshots are pending at any time after
+ * which `sample()` waits. Analyses that need the Hamiltonian or random numbers
+ * (`systemenergy`, `virtualvolume`, `widom`, `savestate`, `sanity`) are always run
+ * in the calling thread on the live system.
+ */
 struct CombinedAnalysis : public BasePointerVector<Analysisbase> {
-    CombinedAnalysis(const json &j, Space &spc, Energy::Hamiltonian &pot);
+    CombinedAnalysis(const json &j, Space &spc, Energy::Hamiltonian &pot, int queue = 0);
     void sample();
+    void flush(); //!< Wait until all pending snapshots have been analysed
     ~CombinedAnalysis();
-}; //!< Aggregates analysis
+
+  private:
+    class Pipeline;
+    std::unique_ptr<Pipeline> pipeline;      // background thread; nullptr if synchronous
+    std::vector<Analysisbase *> synchronous; // analyses run in the calling thread
+};
+
+/**
+ * @brief Analyses demultiplexed by the label of the thermodynamic state
+ *
+ * When labels (temperature and Hamiltonian) are exchanged between replicas, consecutive
+ * samples of a replica belong to different states. A separate set of analyses is therefore
+ * kept for each label, created when the label is first visited and with output files
+ * prefixed by `label{index}.`, and samples are passed to the analyses of the current label
+ * only. A negative label means that labels are not exchanged and no prefix is added.
+ */
+class LabelledAnalysis {
+    json input;
+    Space &spc;
+    Energy::Hamiltonian &pot;
+    int queue;
+
+  public:
+    std::map<int, std::shared_ptr<CombinedAnalysis>> labels; //!< Analyses of each visited label
+    LabelledAnalysis(const json &j, Space &spc, Energy::Hamiltonian &pot, int queue = 0);
+    CombinedAnalysis &operator[](int label); //!< Analyses of label; created if not yet visited
+    void sample(int label);                  //!< Sample analyses of the given, current label
+    static std::string prefix(int label);    //!< File prefix of label
+};
+
+/**
+ * @brief Re-analyse an existing xtc trajectory
+ *
+ * Each worker thread holds its own copy of the space, Hamiltonian, and
+ * analyses. Frames are read in turn from the trajectory whereafter mass
+ * centers and energy terms are updated and all analyses are sampled once per
+ * frame. When done, samples are merged into the first worker. If any of the
+ * analyses cannot be merged (time series, trajectories etc.), a single worker
+ * is used so that frames are analysed in order.
+ */
+class TrajectoryRerun {
+    struct Worker;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+  public:
+    /**
+     * @param j Analysis input, as for `CombinedAnalysis`
+     * @param spc Space used by the first worker; copied to the others
+     * @param pot Hamiltonian used by the first worker; replicated for the others
+     * @param threads Number of worker threads; zero means all available
+     */
+    TrajectoryRerun(const json &j, Space &spc, Energy::Hamiltonian &pot, int threads = 0);
+    ~TrajectoryRerun();
+    size_t run(const std::string &file); //!< Analyse all frames in xtc file and return number of frames
+    CombinedAnalysis &analysis();        //!< Merged analyses
+};
 
 /** @brief Example analysis */
 template <class T, class Enable = void> struct _analyse {
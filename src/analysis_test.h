@@ -0,0 +1,249 @@
+#include "analysis.h"
+#include "energy.h"
+
+namespace Faunus {
+
+using doctest::Approx;
+TEST_SUITE_BEGIN("Analysis");
+
+TEST_CASE("[Faunus] WidomInsertion") {
+    atoms = R"([{ "A": { "sigma": 2.0, "eps": 0.5 } }])"_json.get<decltype(atoms)>();
+    molecules = R"([{ "M": { "atoms": ["A"], "atomic": true } },
+                    { "G": { "atoms": ["A"], "atomic": true } }])"_json.get<decltype(molecules)>();
+    Space spc = R"({
+        "geometry": {"type": "cuboid", "length": [12, 12, 12]},
+        "insertmolecules": [ { "M": { "N": 20 } }, { "G": { "N": 1, "inactive": true } } ]
+    })"_json;
+    Energy::Hamiltonian pot(spc, R"([{ "nonbonded": { "default": [{ "lennardjones": {"mixing": "LB"} }] } }])"_json);
+    pot.key = Energy::Energybase::OLD;
+    pot.init();
+
+    // insertions are generated serially so the average must not depend on the number of threads
+    auto excess = [&](int threads) {
+        Faunus::random = Random(); // same trial positions for each run
+        Analysis::WidomInsertion widom({{"molecule", "G"}, {"ninsert", 50}, {"nstep", 1}, {"threads", threads}},
+                                       spc, pot);
+        for (int sample = 0; sample < 3; sample++) {
+            spc.p[sample].pos.x() += 0.5; // new configuration that replicas must pick up
+            widom.sample();
+        }
+        for (int sample = 0; sample < 3; sample++)
+            spc.p[sample].pos.x() -= 0.5;
+        json j = widom;
+        CHECK(j["widom"]["insertions"] == 150);
+        return j["widom"][u8::mu + "/kT"]["excess"].get<double>();
+    };
+    double serial = excess(1);
+    CHECK(std::isfinite(serial));
+    CHECK(excess(2) == Approx(serial));
+    CHECK(excess(3) == Approx(serial));
+}
+
+TEST_CASE("[Faunus] LabelledAnalysis") {
+    atoms = R"([{ "A": { "sigma": 2.0 } }])"_json.get<decltype(atoms)>();
+    molecules = R"([{ "M": { "atoms": ["A"], "atomic": true } }])"_json.get<decltype(molecules)>();
+    Space spc = R"({
+        "geometry": {"type": "cuboid", "length": [10, 10, 10]},
+        "insertmolecules": [ { "M": { "N": 5 } } ]
+    })"_json;
+    Energy::Hamiltonian pot(spc, json::array());
+    Analysis::LabelledAnalysis analysis(R"([{ "sanity": { "nstep": 1 } }])"_json, spc, pot);
+
+    CHECK(Analysis::LabelledAnalysis::prefix(-1).empty()); // labels not exchanged
+    CHECK(Analysis::LabelledAnalysis::prefix(2) == "label2.");
+
+    // samples are routed to the analyses of the current label only
+    for (int label : {0, 1, 1, 0, 1})
+        analysis.sample(label);
+    REQUIRE(analysis.labels.size() == 2);
+    auto samples = [&](int label) {
+        json j = *analysis[label].front();
+        return j["sanity"]["samples"].get<int>();
+    };
+    CHECK(samples(0) == 2);
+    CHECK(samples(1) == 3);
+}
+
+TEST_CASE("[Faunus] CombinedAnalysis queue") {
+    atoms = R"([{ "A": { "sigma": 2.0 } }])"_json.get<decltype(atoms)>();
+    molecules = R"([{ "D": { "structure": [ {"A": [0, 0, 0]}, {"A": [1, 0, 0]} ] } }])"_json.get<decltype(molecules)>();
+    Space spc = R"({
+        "geometry": {"type": "cuboid", "length": [30, 30, 30]},
+        "insertmolecules": [ { "D": { "N": 4 } } ]
+    })"_json;
+    Energy::Hamiltonian pot(spc, json::array());
+    json input = R"([ { "polymershape": { "molecules": ["D"], "nstep": 2 } },
+                      { "polymershape": { "molecules": ["D"], "nstep": 3, "nskip": 4 } } ])"_json;
+
+    auto move = [&](int step) { // deterministic stretch of each molecule
+        for (size_t k = 0; k < spc.groups.size(); k++) {
+            auto &g = spc.groups[k];
+            (g.begin() + 1)->pos = g.begin()->pos + Point(1.0 + 0.1 * ((step + k) % 5), 0.05 * step, 0);
+            g.cm = Geometry::massCenter(g.begin(), g.end(), spc.geo.getBoundaryFunc(), -g.begin()->pos);
+        }
+    };
+
+    // asynchronous analyses see the same configurations at the same steps as synchronous ones
+    auto run = [&](int queue) {
+        Analysis::CombinedAnalysis analysis(input, spc, pot, queue);
+        for (int step = 0; step < 20; step++) {
+            move(step);
+            analysis.sample();
+        }
+        analysis.flush();
+        json out = json::array();
+        for (auto &ptr : analysis.vec) {
+            json j = *ptr;
+            j.begin()->erase("relative time"); // wall time
+            out.push_back(j);
+        }
+        return out;
+    };
+    json synchronous = run(0), asynchronous = run(2);
+    CHECK(synchronous[0]["Polymer Shape"]["samples"] == 10);
+    CHECK(synchronous[1]["Polymer Shape"]["samples"] == 5);
+    CHECK(synchronous == asynchronous);
+
+    // adaptive sampling requires an analysis that observes a scalar
+    CHECK_THROWS(Analysis::CombinedAnalysis(
+        R"([ { "polymershape": { "molecules": ["D"], "nstep": 2, "adaptive": true } } ])"_json, spc, pot));
+    CHECK_NOTHROW(Analysis::CombinedAnalysis(R"([ { "density": { "nstep": 2, "adaptive": true } } ])"_json, spc, pot));
+}
+
+/** Exposes the pair sampling of `PairFunctionBase` */
+class PairSampler : public Analysis::PairFunctionBase {
+    void _sample() override {}
+
+  public:
+    using PairFunctionBase::hist;
+    using PairFunctionBase::samplePairs;
+    PairSampler(const json &j) : PairFunctionBase(j) {}
+};
+
+TEST_CASE("[Faunus] PairFunctionBase::samplePairs") {
+    Geometry::Chameleon geo(Geometry::Cuboid(10.0), Geometry::CUBOID);
+    Random random;
+    std::vector<Point> a(200), b(150);
+    for (auto &points : {&a, &b})
+        for (auto &point : *points)
+            geo.randompos(point, random);
+    a[0] = {4.9, 0, 0}; // pairs across the periodic boundaries
+    b[0] = {-4.9, 0, 0};
+    a[1] = {0, -4.9, 4.9};
+    b[1] = {0, 4.9, -4.9};
+
+    json j = {{"file", "pairsampler.dat"}, {"name1", "A"}, {"name2", "A"}, {"dr", 0.1}, {"rmax", 3.0}};
+    PairSampler brute(j);
+    j["celllist"] = true;
+    PairSampler cells(j);
+
+    auto compare = [&](const std::vector<Point> &x, const std::vector<Point> &y) {
+        brute.samplePairs(x, y, geo);
+        cells.samplePairs(x, y, geo);
+        REQUIRE(brute.hist.yvec().size() == cells.hist.yvec().size());
+        for (size_t i = 0; i < brute.hist.yvec().size(); i++)
+            CHECK(brute.hist.yvec()[i] == cells.hist.yvec()[i]);
+    };
+    compare(a, b);
+    double close = 0; // pairs closer than 0.5
+    auto x = brute.hist.xvec();
+    for (size_t i = 0; i < x.size(); i++)
+        if (x[i] < 0.5)
+            close += brute.hist.yvec()[i];
+    CHECK(close >= 2);
+    compare(a, a); // each pair counted once
+    CHECK(brute.hist.sumy() > 0);
+}
+
+TEST_CASE("[Faunus] TrajectoryRerun") {
+    atoms = R"([{ "A": { "sigma": 2.0 } }])"_json.get<decltype(atoms)>();
+    molecules = R"([{ "M": { "atoms": ["A"], "atomic": true } }])"_json.get<decltype(molecules)>();
+    Space spc = R"({
+        "geometry": {"type": "cuboid", "length": [10, 10, 10]},
+        "insertmolecules": [ { "M": { "N": 10 } } ]
+    })"_json;
+    Energy::Hamiltonian pot(spc, json::array());
+    const int frames = 9;
+    auto move = [&](int frame) { // deterministic positions well inside the box
+        for (size_t i = 0; i < spc.p.size(); i++)
+            spc.p[i].pos = Point(std::sin(i + 0.3 * frame), std::cos(2.0 * i - frame), std::sin(0.7 * i * frame)) * 4.0;
+    };
+    auto report = [](const Analysis::Analysisbase &analysis) {
+        json j = analysis;
+        j.begin()->erase("relative time"); // wall time
+        j.begin()->erase("blocking");      // needs consecutive samples; dropped when merging
+        return j;
+    };
+    auto slurp = [](const std::string &file) {
+        std::ifstream f(MPI::prefix + file);
+        std::stringstream contents;
+        contents << f.rdbuf();
+        return contents.str();
+    };
+
+    SUBCASE("merge") { // two instances sampling every other frame equal one sampling all frames
+        json rdf_input = {{"name1", "A"}, {"name2", "A"}, {"dr", 0.2}, {"nstep", 1}};
+        auto rdf = [&](const std::string &file) {
+            rdf_input["file"] = file;
+            return std::make_unique<Analysis::AtomRDF>(rdf_input, spc);
+        };
+        auto all = rdf("merge_all.dat"), even = rdf("merge_even.dat"), odd = rdf("merge_odd.dat");
+        json density_input = {{"nstep", 1}};
+        Analysis::Density all_density(density_input, spc), even_density(density_input, spc),
+            odd_density(density_input, spc);
+        for (int frame = 0; frame < frames; frame++) {
+            move(frame);
+            all->sample();
+            all_density.sample();
+            (frame % 2 ? odd : even)->sample();
+            (frame % 2 ? odd_density : even_density).sample();
+        }
+        even->merge(*odd);
+        even_density.merge(odd_density);
+        CHECK(report(*even) == report(*all));
+        CHECK(report(even_density) == report(all_density));
+        CHECK(json(all_density)["density"].count("blocking") == 1);
+        CHECK(json(even_density)["density"].count("blocking") == 0);
+        for (auto analysis : {&all, &even, &odd})
+            analysis->reset(); // histograms are saved upon destruction
+        CHECK(not slurp("merge_all.dat").empty());
+        CHECK(slurp("merge_even.dat") == slurp("merge_all.dat"));
+        for (auto file : {"merge_all.dat", "merge_even.dat", "merge_odd.dat"})
+            std::remove((MPI::prefix + file).c_str());
+    }
+
+    SUBCASE("workers") { // the number of workers does not affect the merged result
+        const std::string trajectory = "rerun_test.xtc";
+        {
+            FormatXTC xtc(10);
+            for (int frame = 0; frame < frames; frame++) {
+                move(frame);
+                xtc.setbox(spc.geo.getLength());
+                xtc.save(trajectory, spc.p.begin(), spc.p.end());
+            }
+        } // file is closed
+        json input = R"([ { "atomrdf": { "file": "rerun_rdf.dat", "name1": "A", "name2": "A", "dr": 0.2, "nstep": 1 } },
+                          { "density": { "nstep": 1 } } ])"_json;
+        auto rerun = [&](int threads) {
+            json out = json::array();
+            {
+                Analysis::TrajectoryRerun rerun(input, spc, pot, threads);
+                CHECK(rerun.run(trajectory) == size_t(frames));
+                for (auto &analysis : rerun.analysis())
+                    out.push_back(report(*analysis));
+            } // histograms are saved upon destruction
+            out.push_back(slurp("rerun_rdf.dat"));
+            out.push_back(slurp("rho-M.dat"));
+            return out;
+        };
+        json single = rerun(1);
+        CHECK(single[0]["atomrdf"]["samples"] == frames);
+        CHECK(single == rerun(3));
+        for (auto file : {"rerun_rdf.dat", "rho-M.dat"})
+            std::remove((MPI::prefix + file).c_str());
+        std::remove(trajectory.c_str());
+    }
+}
+
+TEST_SUITE_END();
+} // namespace Faunus
@@ -44,8 +44,8 @@ void to_json(json &j, const AtomData &a) {
           {"q", a.charge},
           {"dp", a.dp / 1.0_angstrom},
           {"dprot", a.dprot / 1.0_rad},
-          {"tension", a.tension * 1.0_angstrom * 1.0_angstrom / 1.0_kJmol},
-          {"tfe", a.tfe * 1.0_angstrom * 1.0_angstrom * 1.0_molar / 1.0_kJmol},
+          {"tension", a.tension},
+          {"tfe", a.tfe},
           {"mu", a.mu},
           {"mulen", a.mulen},
           {"scdir", a.scdir},
@@ -81,8 +81,8 @@ void from_json(const json &j, AtomData &a) {
         a.scdir = val.value("scdir", a.scdir);
         a.sclen = val.value("sclen", a.sclen);
         a.mw = val.value("mw", a.mw);
-        a.tension = val.value("tension", a.tension) * 1.0_kJmol / (1.0_angstrom * 1.0_angstrom);
-        a.tfe = val.value("tfe", a.tfe) * 1.0_kJmol / (1.0_angstrom * 1.0_angstrom * 1.0_molar);
+        a.tension = val.value("tension", a.tension); // kJ/mol/Å^2; converted by energy terms at their temperature
+        a.tfe = val.value("tfe", a.tfe);             // kJ/mol/Å^2/M
         a.hydrophobic = val.value("hydrophobic", false);
         a.implicit = val.value("implicit", false);
         if (val.count("activity") == 1)
@@ -29,8 +29,8 @@ class AtomData { // has to be a class when a constant reference is used
     double dprot = 0;         //!< Rotational displacement parameter [degrees]
     double mulen = 0;         //!< Dipole moment scalar [eÃ]
     double sclen = 0;         //!< Sphere-cylinder length [angstrom]
-    double tension = 0;       //!< Surface tension [kT/Å^2]
-    double tfe = 0;           //!< Transfer free energy [J/mol/angstrom^2/M]
+    double tension = 0;       //!< Surface tension [kJ/mol/Å^2]; converted to kT by the energy terms using it
+    double tfe = 0;           //!< Transfer free energy [kJ/mol/Å^2/M]; converted to kT by the energy terms using it
     Point mu = {0, 0, 0};     //!< Dipole moment unit vector
     Point scdir = {1, 0, 0};  //!< Sphero-cylinder direction
     bool hydrophobic = false; //!< Is the particle hydrophobic?
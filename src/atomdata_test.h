@@ -29,7 +29,7 @@ TEST_CASE("[Faunus] AtomData") {
     // CHECK_THROWS_AS_MESSAGE(v.front().getProperty("eps_unknown"), std::runtime_error, "unknown atom property");
     CHECK(v.front().sigma == Approx(2.5e-10_m));
     CHECK(v.front().activity == Approx(0.01_molar));
-    CHECK(v.back().tfe == Approx(0.98_kJmol / (1.0_angstrom * 1.0_angstrom * 1.0_molar)));
+    CHECK(v.back().tfe == Approx(0.98)); // kJ/mol/Å^2/M; converted to kT by energy terms
 
     AtomData a = json(v.back()); // AtomData -> JSON -> AtomData
 
@@ -41,8 +41,8 @@ TEST_CASE("[Faunus] AtomData") {
     CHECK(a.dp == Approx(9.8));
     CHECK(a.dprot == Approx(3.14));
     CHECK(a.mw == Approx(1.1));
-    CHECK(a.tfe == Approx(0.98_kJmol / 1.0_angstrom / 1.0_angstrom / 1.0_molar));
-    CHECK(a.tension == Approx(0.023_kJmol / 1.0_angstrom / 1.0_angstrom));
+    CHECK(a.tfe == Approx(0.98));
+    CHECK(a.tension == Approx(0.023));
 
     auto it = findName(v, "B");
     CHECK_EQ(it->id(), 1);
@@ -7,6 +7,10 @@
 #include <map>
 #include <regex>
 #include <chrono>
+#include <array>
+#include <algorithm>
+#include <memory>
+#include <cstddef>
 
 #include "average.h"
 
@@ -1948,6 +1952,15 @@ namespace Faunus
                     return vec.at(i);
                 } // return y value for given x
 
+                auto &operator+=(const Equidistant2DTable<Tx,Ty,centerbin> &other) {
+                    assert(dx()==other.dx() && xmin()==other.xmin() && "tables must have identical binning");
+                    if (other.vec.size() > vec.size())
+                        vec.resize(other.vec.size(), Ty());
+                    for (size_t i=0; i<other.vec.size(); i++)
+                        vec[i] += other.vec[i];
+                    return *this;
+                } //!< Add y-values from table with identical binning
+
                 // can be optinally used to customize streaming out, normalise etc.
                 std::function<void(std::ostream&,Tx,Ty)> stream_decorator=nullptr;
 
@@ -2016,6 +2029,17 @@ namespace Faunus
             CHECK( y.xmax() == Approx(1.0) );
         }
 
+        SUBCASE("merge") {
+            Equidistant2DTable<double> a(0.5, 0), b(0.5, 0);
+            a(0.2) = 1;
+            b(0.2) = 2;
+            b(1.1) = 3;
+            a += b;
+            CHECK( a.size() == 3 );
+            CHECK( a(0.0) == Approx(3) );
+            CHECK( a(1.0) == Approx(3) );
+        }
+
     }
 #endif
 
@@ -2055,6 +2079,8 @@ namespace Faunus
                     auto total = std::chrono::duration_cast<Tunit>(now - t0);
                     return delta.count() / double(total.count());
                 }
+
+                Tunit duration() const { return delta; } //!< Accumulated time in between start/stop calls
         };
 
     /**
@@ -2152,6 +2178,175 @@ namespace Faunus
     }
 #endif
 
+    /**
+     * @brief Vector with inline storage for up to `N` elements
+     *
+     * Elements are kept in a fixed size array until the size exceeds `N`
+     * whereafter a heap allocated vector is used. `clear()` returns to the
+     * inline storage but keeps the heap capacity so that a container that is
+     * reused, e.g. in every Monte Carlo move, will stop allocating after warm-up.
+     */
+    template <typename T, std::size_t N> class SmallVector {
+        std::array<T, N> local;
+        std::vector<T> heap;
+        std::size_t n = 0;
+        bool spilled = false; //!< True if elements are in `heap`
+
+      public:
+        typedef T value_type;
+        typedef T *iterator;
+        typedef const T *const_iterator;
+
+        SmallVector() = default;
+        SmallVector(std::initializer_list<T> l) { assign(l.begin(), l.end()); }
+
+        std::size_t size() const { return n; }
+        bool empty() const { return n == 0; }
+        T *data() { return spilled ? heap.data() : local.data(); }
+        const T *data() const { return spilled ? heap.data() : local.data(); }
+        iterator begin() { return data(); }
+        iterator end() { return data() + n; }
+        const_iterator begin() const { return data(); }
+        const_iterator end() const { return data() + n; }
+        T &operator[](std::size_t i) { return data()[i]; }
+        const T &operator[](std::size_t i) const { return data()[i]; }
+        T &front() { return data()[0]; }
+        const T &front() const { return data()[0]; }
+        T &back() { return data()[n - 1]; }
+        const T &back() const { return data()[n - 1]; }
+
+        void clear() {
+            heap.clear();
+            spilled = false;
+            n = 0;
+        }
+
+        void resize(std::size_t size) {
+            if (size > N and not spilled) {
+                heap.assign(local.begin(), local.begin() + n);
+                spilled = true;
+            }
+            if (spilled)
+                heap.resize(size);
+            else
+                std::fill(local.begin() + std::min(n, size), local.begin() + size, T());
+            n = size;
+        }
+
+        void push_back(const T &value) {
+            if (n == N and not spilled) {
+                heap.assign(local.begin(), local.end());
+                spilled = true;
+            }
+            if (spilled)
+                heap.push_back(value);
+            else
+                local[n] = value;
+            n++;
+        }
+
+        template <typename Tit> void assign(Tit first, Tit last) {
+            clear();
+            for (; first != last; ++first)
+                push_back(*first);
+        }
+
+        bool operator==(const SmallVector &other) const { return std::equal(begin(), end(), other.begin(), other.end()); }
+    };
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+    TEST_CASE("[Faunus] SmallVector")
+    {
+        SmallVector<int, 2> v;
+        CHECK(v.empty());
+        v.push_back(3);
+        v.push_back(1);
+        CHECK(v.size() == 2);
+        v.push_back(2); // spill to heap
+        CHECK(v.size() == 3);
+        std::sort(v.begin(), v.end());
+        CHECK(v == SmallVector<int, 2>({1, 2, 3}));
+        CHECK(v.back() == 3);
+        auto copy = v;
+        v.clear();
+        CHECK(v.empty());
+        CHECK(copy.size() == 3);
+        v.resize(1);
+        v[0] = 7;
+        CHECK(v.front() == 7);
+        v.assign(copy.begin(), copy.end());
+        CHECK(std::vector<int>(v.begin(), v.end()) == std::vector<int>({1, 2, 3}));
+    }
+#endif
+
+    /**
+     * @brief Allocator that recycles single element blocks through a thread local free list
+     *
+     * Intended for small objects that are repeatedly created and destroyed, for example
+     * with `std::allocate_shared`. After warm-up, allocation amounts to popping a pointer
+     * from the free list. Pooled memory is released when the owning thread exits.
+     */
+    template <typename T> class PoolAllocator {
+        struct FreeList {
+            std::vector<void *> blocks;
+            ~FreeList() {
+                for (auto ptr : blocks)
+                    ::operator delete(ptr);
+                destroyed() = true;
+            }
+        };
+        static bool &destroyed() {
+            static thread_local bool flag = false;
+            return flag;
+        } //!< True after the thread's free list has been destructed
+        static FreeList &freelist() {
+            static thread_local FreeList list;
+            return list;
+        }
+        static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types not supported");
+
+      public:
+        typedef T value_type;
+        PoolAllocator() = default;
+        template <typename U> PoolAllocator(const PoolAllocator<U> &) {}
+
+        T *allocate(std::size_t n) {
+            if (n == 1 and not destroyed()) {
+                auto &blocks = freelist().blocks;
+                if (not blocks.empty()) {
+                    void *ptr = blocks.back();
+                    blocks.pop_back();
+                    return static_cast<T *>(ptr);
+                }
+            }
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T *ptr, std::size_t n) {
+            if (n == 1 and not destroyed())
+                freelist().blocks.push_back(ptr);
+            else
+                ::operator delete(ptr);
+        }
+
+        template <typename U> bool operator==(const PoolAllocator<U> &) const { return true; }
+        template <typename U> bool operator!=(const PoolAllocator<U> &) const { return false; }
+    };
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+    TEST_CASE("[Faunus] PoolAllocator")
+    {
+        PoolAllocator<double> alloc;
+        double *a = alloc.allocate(1);
+        alloc.deallocate(a, 1);
+        double *b = alloc.allocate(1);
+        CHECK(a == b); // recycled
+        alloc.deallocate(b, 1);
+        auto ptr = std::allocate_shared<std::vector<int>>(alloc, 3, 1);
+        CHECK(ptr->size() == 3);
+    }
+#endif
+
     template <typename T> struct BasePointerVector {
         std::vector<std::shared_ptr<T>> vec; //!< Vector of shared pointers to base class
 
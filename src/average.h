@@ -4,6 +4,7 @@
 #include <ostream>
 #include <istream>
 #include <cmath>
+#include <vector>
 
 namespace Faunus
 {
@@ -57,6 +58,13 @@ namespace Faunus
           return *this;
       } //!< Add value to current set
 
+      Average& operator+=(const Average &a) {
+          cnt += a.cnt;
+          sum += a.sum;
+          sqsum += a.sqsum;
+          return *this;
+      } //!< Merge samples from another average (with correct weights)
+
       operator double() const {
           return avg();
       } //!< Static cast operator
@@ -103,9 +111,154 @@ namespace Faunus
         CHECK( a<b ); // a.avg() < b.avg()
         CHECK( (a+b).avg() == doctest::Approx(2) );
 
+        auto c = a;
+        c += b; // merge
+        CHECK( c.size()==4 );
+        CHECK( c.avg() == doctest::Approx(2) );
+
         b = 1.0; // assign from double
         CHECK( b.size()==1 );
     }
 #endif
 
+  /**
+   * @brief Average and error of correlated data using online blocking
+   *
+   * Implements the blocking transformation of Flyvbjerg and Petersen,
+   * [doi:10/bh4tj3](http://dx.doi.org/10.1063/1.457480), without storing
+   * the time series: level `k` collects averages over blocks of `2^k`
+   * consecutive values so that memory scales as `log2(N)`. Each level uses
+   * Welford's algorithm to avoid cancellation for large, weakly fluctuating
+   * values such as total energies.
+   *
+   * The error of the mean is taken as the largest estimate among levels with
+   * at least `minblocks` blocks, and the statistical inefficiency, `g=1+2tau`,
+   * is the ratio between this and the naive, uncorrelated variance of the mean.
+   */
+  template<class T=double> class BlockAverage
+  {
+      struct Level {
+          unsigned long long int cnt=0; //!< Number of blocks
+          double mean=0;                //!< Mean of block averages
+          double m2=0;                  //!< Sum of squared deviations from mean
+          T pending=0;                  //!< First value of incomplete pair
+          bool haspending=false;        //!< True if `pending` is waiting for a partner
+
+          void add(double x) {
+              cnt++;
+              double d = x - mean;
+              mean += d / cnt;
+              m2 += d * (x - mean);
+          }
+
+          void merge(const Level &other) {
+              if (other.cnt>0) {
+                  double n = double(cnt + other.cnt);
+                  double d = other.mean - mean;
+                  mean += d * other.cnt / n;
+                  m2 += other.m2 + d * d * cnt * other.cnt / n;
+                  cnt += other.cnt;
+              }
+          }
+
+          double variance() const { return cnt>0 ? m2 / cnt : 0; } //!< Population variance
+
+          double error() const {
+              return cnt>1 ? std::sqrt( variance() / (cnt-1) ) : 0;
+          } //!< Error of the mean assuming uncorrelated blocks
+      };
+
+      std::vector<Level> levels;
+
+    public:
+      unsigned int minblocks=64; //!< Minimum number of blocks for a level to enter the error estimate
+
+      void add(T x) {
+          for (size_t k=0; ; k++) {
+              if (k==levels.size())
+                  levels.emplace_back();
+              auto &level = levels[k];
+              level.add(x);
+              if (not level.haspending) {
+                  level.pending = x;
+                  level.haspending = true;
+                  return;
+              }
+              x = (level.pending + x) / 2;
+              level.haspending = false;
+          }
+      } //!< Add value to current set
+
+      BlockAverage& operator+=(T x) {
+          add(x);
+          return *this;
+      } //!< Add value to current set
+
+      BlockAverage& operator+=(const BlockAverage &other) {
+          if (levels.size() < other.levels.size())
+              levels.resize(other.levels.size());
+          for (size_t k=0; k<other.levels.size(); k++)
+              levels[k].merge(other.levels[k]);
+          return *this;
+      } //!< Merge blocks from an independent set (incomplete pairs are not combined)
+
+      void clear() { levels.clear(); } //!< Clear all data
+
+      bool empty() const { return levels.empty(); } //!< True if empty
+
+      auto size() const { return empty() ? 0ull : levels.front().cnt; } //!< Number of samples
+
+      double avg() const { return empty() ? 0 : levels.front().mean; } //!< Average
+
+      double stdev() const { return empty() ? 0 : std::sqrt( levels.front().variance() ); } //!< Standard deviation
+
+      double error() const {
+          if (empty())
+              return 0;
+          double err = levels.front().error();
+          for (auto &level : levels)
+              if (level.cnt >= minblocks)
+                  err = std::max(err, level.error());
+          return err;
+      } //!< Error of the mean, corrected for correlations
+
+      double inefficiency() const {
+          if (size()<2 || levels.front().m2 <= 0)
+              return 1;
+          return std::max(1.0, std::pow(error() / levels.front().error(), 2));
+      } //!< Statistical inefficiency, g=1+2tau, where tau is the correlation time in units of samples
+
+      double correlation() const { return (inefficiency() - 1) / 2; } //!< Correlation time in units of samples
+  };
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+    TEST_CASE("[Faunus] BlockAverage") {
+        BlockAverage<double> a;
+        CHECK( a.empty() );
+        CHECK( a.inefficiency() == 1 );
+
+        // alternating series: anti-correlated, so blocking never increases the error
+        for (int i=0; i<1024; i++)
+            a += (i%2==0) ? 1.0 : -1.0;
+        CHECK( a.size() == 1024 );
+        CHECK( a.avg() == doctest::Approx(0) );
+        CHECK( a.stdev() == doctest::Approx(1) );
+        CHECK( a.inefficiency() == doctest::Approx(1) );
+
+        // each value repeated 8 times: g should approach the repeat length
+        BlockAverage<double> b;
+        for (int i=0; i<4096; i++)
+            b += ((i/8) % 2==0) ? 1.0 : -1.0;
+        CHECK( b.inefficiency() == doctest::Approx(8).epsilon(0.2) );
+        CHECK( b.correlation() == doctest::Approx(3.5).epsilon(0.3) );
+
+        // merge two identical sets
+        auto c = b;
+        c += b;
+        CHECK( c.size() == 2 * b.size() );
+        CHECK( c.avg() == doctest::Approx(b.avg()) );
+        CHECK( c.stdev() == doctest::Approx(b.stdev()) );
+    }
+#endif
+
 }//namespace
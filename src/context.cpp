@@ -0,0 +1,33 @@
+#include "context.h"
+#include "units.h"
+#include "mpicontroller.h"
+#include "move.h"
+
+namespace Faunus {
+
+Context Context::current() {
+    Context context;
+    context.temperature = pc::temperature;
+    context.prefix = MPI::prefix;
+    context.random = Faunus::random;
+    context.slump = Move::Movebase::slump;
+    return context;
+}
+
+void Context::activate() const {
+    pc::temperature = temperature;
+    MPI::prefix = prefix;
+    Faunus::random = random;
+    Move::Movebase::slump = slump;
+}
+
+Context Context::stream(uint64_t id) const {
+    Context context = *this;
+    auto key = random; // draw the key from a copy to leave this context untouched
+    ParallelRandom streams(key.engine());
+    context.random.seed(streams.stream(2 * id));
+    context.slump.seed(streams.stream(2 * id + 1));
+    return context;
+}
+
+} // namespace Faunus
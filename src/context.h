@@ -0,0 +1,74 @@
+#pragma once
+
+#include "random.h"
+#include <string>
+#include <thread>
+
+namespace Faunus {
+
+/**
+ * @brief Temperature, file prefix and random number generators of a simulation
+ *
+ * Throughout the code these are accessed as thread local variables, `pc::temperature`,
+ * `MPI::prefix`, `Faunus::random`, and `Move::Movebase::slump`, so that several
+ * simulations (replicas) can run concurrently in a single process. A context is an
+ * explicit copy owned by a simulation and must be activated in every thread working
+ * on its behalf as thread local variables of a new thread start out with their
+ * initial values, regardless of the thread that started it.
+ *
+ * ```{.cpp}
+ *     Context context = Context::current();                // copy of calling thread
+ *     std::thread worker([context] { context.activate(); }); // same state in worker
+ * ```
+ *
+ * Concurrent simulations or workers drawing random numbers should not use
+ * identical generators, and `stream()` gives copies with independent generators.
+ */
+struct Context {
+    double temperature; //!< Temperature (K)
+    std::string prefix; //!< Prefix for input and output files
+    Random random;      //!< Global random number generator
+    Random slump;       //!< Random number generator of moves
+
+    static Context current(); //!< Copy of the context of the calling thread
+    void activate() const;    //!< Make this the context of the calling thread
+
+    /**
+     * @brief Copy with generators seeded from independent, reproducible `ParallelRandom` streams
+     * @param id Stream number, i.e. replica or thread index
+     *
+     * The streams are keyed by the state of `random`, so that a seed given in the input propagates.
+     */
+    Context stream(uint64_t id) const;
+};
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+TEST_CASE("[Faunus] Context") {
+    Context context = Context::current();
+    context.temperature = 350;
+    context.prefix = "replica1.";
+    context.random.engine.seed(1);
+    Random expected = context.random;
+
+    Context seen;
+    std::thread([&] { seen = Context::current(); }).join();
+    CHECK(seen.prefix != context.prefix); // a new thread starts out with initial values...
+    std::thread([&] {
+        context.activate();
+        seen = Context::current();
+    }).join();
+    CHECK(seen.temperature == 350); // ...until a context is activated
+    CHECK(seen.prefix == "replica1.");
+    CHECK(seen.random() == expected());
+    CHECK(Context::current().temperature != 350); // calling thread is untouched
+
+    // independent but reproducible generators
+    Context first = context.stream(0), second = context.stream(1);
+    CHECK(first.prefix == context.prefix);
+    CHECK(first.random() != second.random());
+    CHECK(first.random() != first.slump());
+    CHECK(context.stream(1).random() == context.stream(1).random());
+}
+#endif
+
+} // namespace Faunus
@@ -261,7 +261,7 @@ double Bonded::energy(Change &change) {
                         if (not spc.groups[group.index].empty())
                             energy += sum_energy(intra_group);
                     } else { // only partial update of affected atoms
-                        std::vector<int> atoms_ndx;
+                        atoms_ndx.clear();
                         // an offset is the index of the first particle in the group
                         int offset = std::distance(spc.p.begin(), spc.groups[group.index].begin());
                         // add an offset to the group atom indices to get the absolute indices
@@ -303,7 +303,7 @@ void Hamiltonian::addEwald(const json &j, Space &spc) {
             emplace_back<Energy::Ewald<>>(_j, spc);
 }
 
-Hamiltonian::Hamiltonian(Space &spc, const json &j) {
+Hamiltonian::Hamiltonian(Space &spc, const json &j) : input(j) {
     using namespace Potential;
 
     typedef CombinedPairPotential<NewCoulombGalore, LennardJones> CoulombLJ; // temporary name
@@ -409,22 +409,84 @@ Hamiltonian::Hamiltonian(Space &spc, const json &j) {
         if (not a.bonds.empty() and this->find<Energy::Bonded>().empty())
             faunus_logger->warn(a.name + " bonds specified in topology but missing in energy");
 }
+/**
+ * The replica is constructed from the original input and hence shares no state with this
+ * Hamiltonian, allowing concurrent evaluation in different threads. Note that `spc` should
+ * have the same structure as the space used for this Hamiltonian and that `init()` must be
+ * called before use. Penalty functions cannot be replicated as they write to disk.
+ */
+std::shared_ptr<Hamiltonian> Hamiltonian::replica(Space &spc) const {
+    if (not this->find<Energy::Penalty>().empty())
+        throw std::runtime_error("hamiltonian with penalty function cannot be replicated");
+    auto pot = std::make_shared<Hamiltonian>(spc, input);
+    pot->key = key;
+    return pot;
+}
+
+/**
+ * Terms are created exactly as in the constructor. The key is kept, but `init()` must be called
+ * before use. Terms refer to the Hamiltonian they are created in only during construction
+ * (self-energies are added to it), so they can safely be moved to this instance.
+ */
+void Hamiltonian::reset(Space &spc, const json &j) {
+    Hamiltonian other(spc, j);
+    vec = other.vec;
+    input = other.input;
+    maxenergy = other.maxenergy;
+}
+
+/**
+ * This is much cheaper than `init()` and is used to refresh a replica after its space has been
+ * synced with that of `other`. Each term copies its state with `Energybase::copyFrom()` which only
+ * reads `other`, so that several replicas may be refreshed concurrently.
+ */
+void Hamiltonian::copyState(const Hamiltonian &other) {
+    if (other.size() != size())
+        throw std::runtime_error("hamiltonian mismatch");
+    for (size_t i = 0; i < size(); i++)
+        vec[i]->copyFrom(*other.vec[i]);
+}
+
 double Hamiltonian::energy(Change &change) {
     double du = 0;
-    for (auto i : this->vec) { // loop over terms in Hamiltonian
+    term_energies.assign(this->vec.size(), std::numeric_limits<double>::quiet_NaN());
+    for (size_t k = 0; k < this->vec.size(); k++) { // loop over terms in Hamiltonian
+        auto &i = this->vec[k];
         i->key = key;
         i->timer.start(); // time each term
-        du += i->energy(change);
+        term_energies[k] = i->energy(change);
+        du += term_energies[k];
         i->timer.stop();
         if (du >= maxenergy)
             break; // stop summing energies
     }
     return du;
 }
+
+void EnergyLedger::reset(const std::vector<double> &energies) {
+    u = energies;
+    valid = std::all_of(u.begin(), u.end(), [](double x) { return std::isfinite(x); });
+}
+
+void EnergyLedger::accept(const std::vector<double> &unew, const std::vector<double> &uold) {
+    if (valid) {
+        if (unew.size() != u.size() or uold.size() != u.size())
+            valid = false;
+        else
+            for (size_t k = 0; k < u.size(); k++) {
+                u[k] += unew[k] - uold[k];
+                if (not std::isfinite(u[k]))
+                    valid = false;
+            }
+    }
+}
 void Hamiltonian::init() {
     for (auto i : this->vec)
         i->init();
 }
+bool Hamiltonian::interactsBeyond(double distance) const {
+    return std::any_of(vec.begin(), vec.end(), [&](auto &term) { return term->interactsBeyond(distance); });
+}
 void Hamiltonian::sync(Energybase *basePtr, Change &change) {
     auto other = dynamic_cast<decltype(this)>(basePtr);
     if (other)
@@ -445,6 +507,10 @@ SASAEnergy::SASAEnergy(Space &spc, double cosolute_concentration, double probe_r
     cite = "doi:10.12688/f1000research.7931.1"; // todo predecessor constructor
     parameters = freesasa_default_parameters;
     parameters.probe_radius = probe_radius;
+    for (auto &a : atoms) {
+        tension.push_back(a.tension * 1.0_kJmol / (1.0_angstrom * 1.0_angstrom));
+        tfe.push_back(a.tfe * 1.0_kJmol / (1.0_angstrom * 1.0_angstrom * 1.0_molar));
+    }
     init();
 }
 
@@ -497,8 +563,8 @@ double SASAEnergy::energy(Change &change) {
     double u = 0, A = 0;
     updateSASA(spc.p, change); // ideally we want
     for (size_t i = 0; i < spc.p.size(); ++i) {
-        auto &a = atoms[spc.p[i].id];
-        u += sasa[i] * (a.tension + cosolute_concentration * a.tfe);
+        auto id = spc.p[i].id;
+        u += sasa[i] * (tension[id] + cosolute_concentration * tfe[id]);
         A += sasa[i];
     }
     avgArea += A; // sample average area for accepted confs.
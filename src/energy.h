@@ -2,10 +2,12 @@
 
 #include "bonds.h"
 #include "externalpotential.h" // Energybase implemented here
+#include "potentials.h"
 #include "space.h"
 #include "aux/iteratorsupport.h"
 #include <range/v3/view.hpp>
 #include <Eigen/Dense>
+#include <numeric>
 #include "spdlog/spdlog.h"
 
 #ifdef ENABLE_FREESASA
@@ -143,6 +145,12 @@ template <bool eigenopt = false /** use Eigen matrix ops where possible */> stru
                     auto g_new = spc->groups.at(cg.index);
                     auto g_old = old->groups.at(cg.index);
                     for (auto i : cg.atoms) {
+                        if (change.chargeMove and i < g_new.size() and i < g_old.size()) { // same position; only dq
+                            double dq = (g_new.begin() + i)->charge - (g_old.begin() + i)->charge;
+                            if (dq != 0)
+                                Q += q.cwiseProduct((g_new.begin() + i)->pos).array().cos().prod() * dq;
+                            continue;
+                        }
                         if (i < g_new.size())
                             Q += q.cwiseProduct((g_new.begin() + i)->pos).array().cos().prod() *
                                  (g_new.begin() + i)->charge;
@@ -156,6 +164,14 @@ template <bool eigenopt = false /** use Eigen matrix ops where possible */> stru
                     auto g_new = spc->groups.at(cg.index);
                     auto g_old = old->groups.at(cg.index);
                     for (auto i : cg.atoms) {
+                        if (change.chargeMove and i < g_new.size() and i < g_old.size()) { // same position; only dq
+                            double dq = (g_new.begin() + i)->charge - (g_old.begin() + i)->charge;
+                            if (dq != 0) {
+                                double _new = q.dot((g_new.begin() + i)->pos);
+                                Q += dq * EwaldData::Tcomplex(std::cos(_new), std::sin(_new));
+                            }
+                            continue;
+                        }
                         if (i < g_new.size()) {
                             double _new = q.dot((g_new.begin() + i)->pos);
                             Q += (g_new.begin() + i)->charge * EwaldData::Tcomplex(std::cos(_new), std::sin(_new));
@@ -287,6 +303,8 @@ template <class Policy = PolicyIonIon<>> class Ewald : public Energybase {
         policy.updateComplex(data); // brute force. todo: be selective
     }
 
+    bool interactsBeyond(double) const override { return true; } // long-ranged
+
     double energy(Change &change) override {
         double u = 0;
         if (change) {
@@ -359,6 +377,7 @@ class Bonded : public Energybase {
     typedef BasePointerVector<Potential::BondData> BondVector;
     BondVector inter;                // inter-molecular bonds
     std::map<int, BondVector> intra; // intra-molecular bonds
+    std::vector<int> atoms_ndx;      // scratch buffer for absolute indices of changed atoms
 
   private:
     void update_intra();                              // finds and adds all intra-molecular bonds of active molecules
@@ -381,6 +400,202 @@ template <typename Tpairpot> class Nonbonded : public Energybase {
     PairMatrix<double> cutoff2; // matrix w. group-to-group cutoff
     std::vector<const Particle *> i_interact_with_these;
 
+    /*
+     * Analytic volume scaling for atomic systems w. inverse power pair potentials.
+     * `sums` holds the decomposed energy of the full system while `partial` collects
+     * the pairs visited by `i2i()` in the latest call to `energy()`. For volume and
+     * full changes, `partial` holds the full system and `partial_all` is set.
+     */
+    Potential::InversePowerSums sums, partial;
+    Point sums_box = {0, 0, 0};              // box lengths at which `sums` are valid; zero if invalid
+    const Change *partial_change = nullptr; // change object used to collect `partial`
+    bool partial_all = false;
+    Average<double> dV_analytic; // fraction of volume changes handled analytically
+
+    /*
+     * Scale factor of isotropic volume change since `sums` were last updated. Returns
+     * zero if unavailable, i.e. if the sums are invalid or if the change was anisotropic.
+     */
+    double isotropicScaling() const {
+        if (sums_box.minCoeff() > 0) {
+            Point s = spc.geo.getLength().cwiseQuotient(sums_box);
+            if (s.maxCoeff() - s.minCoeff() < 1e-10 * s.x())
+                return s.x();
+        }
+        return 0;
+    }
+
+    template <typename T> inline double decomposedPairEnergy(const T &a, const T &b, const Point &r, std::true_type) {
+        return pairpot.decompose(a, b, r, partial);
+    }
+
+    template <typename T> inline double decomposedPairEnergy(const T &a, const T &b, const Point &r, std::false_type) {
+        return pairpot(a, b, r);
+    }
+
+    /*
+     * Electric potential at each active particle due to all other active particles in the
+     * accepted state, indexed as `Space::p`, as well as the accepted charges. For charge moves
+     * this gives the energy of the changed particles without visiting all pairs. In the old
+     * state, `energy()` stores the changed particles in `site_pending` which is then used to
+     * update the potentials upon acceptance.
+     */
+    struct Site {
+        int index; // index in `Space::p`
+        int group; // index in `Space::groups`
+        Point pos;
+        double charge;
+    };
+    std::vector<double> site_phi, site_charge;
+    std::vector<Site> site_pending;
+    const Change *site_change = nullptr; // change object used to collect `site_pending`
+    bool site_valid = false;
+    bool site_rebuild_warned = false; // true once the O(N^2) rebuild after a change in N has been reported
+
+    template <typename T> inline double pairElectricPotential(double charge, const T &r, std::true_type) const {
+        return pairpot.electricPotential(charge, r);
+    }
+
+    template <typename T> inline double pairElectricPotential(double, const T &, std::false_type) const {
+        return 0;
+    }
+
+    inline double pairElectricPotential(double charge, const Point &r) const {
+        return pairElectricPotential(charge, r, Potential::has_electric_potential<Tpairpot>());
+    }
+
+    std::vector<Site> changedSites(const Change &change) { // active particles touched by `change`
+        std::vector<Site> sites;
+        for (auto &d : change.groups) {
+            auto &g = spc.groups.at(d.index);
+            int first = std::distance(spc.p.begin(), g.begin());
+            auto add = [&](int i) {
+                sites.push_back({first + i, d.index, spc.p[first + i].pos, spc.p[first + i].charge});
+            };
+            if (d.all or d.atoms.empty())
+                for (int i = 0; i < int(g.size()); i++)
+                    add(i);
+            else
+                for (int i : d.atoms)
+                    if (i < int(g.size()))
+                        add(i);
+        }
+        return sites;
+    }
+
+    bool isPairExcluded(const Site &a, const Site &b) {
+        if (a.group != b.group)
+            return false;
+        int first = std::distance(spc.p.begin(), spc.groups[a.group].begin());
+        return molecules.at(spc.groups[a.group].id).isPairExcluded(a.index - first, b.index - first);
+    }
+
+    double sitePotential(const Site &site) { // electric potential at `site` from all other active particles
+        double phi = 0;
+        for (int ig = 0; ig < int(spc.groups.size()); ig++) {
+            auto &g = spc.groups[ig];
+            int first = std::distance(spc.p.begin(), g.begin());
+            for (int j = first; j < first + int(g.size()); j++)
+                if (j != site.index and not(ig == site.group and isPairExcluded(site, {j, ig, {}, 0})))
+                    phi += pairElectricPotential(spc.p[j].charge, spc.geo.vdist(site.pos, spc.p[j].pos));
+        }
+        return phi;
+    }
+
+    void updateSitePotentials() { // O(N^2) update of all potentials
+        site_phi.assign(spc.p.size(), 0);
+        site_charge.resize(spc.p.size());
+        for (auto gi = spc.groups.begin(); gi != spc.groups.end(); ++gi) {
+            auto &molecule = molecules.at(gi->id);
+            for (auto i = gi->begin(); i != gi->end(); ++i) {
+                auto k = std::distance(spc.p.begin(), i);
+                site_charge[k] = i->charge;
+                auto addPair = [&](const Particle &j) {
+                    Point r = spc.geo.vdist(i->pos, j.pos);
+                    site_phi[k] += pairElectricPotential(j.charge, r);
+                    site_phi[&j - &spc.p.front()] += pairElectricPotential(i->charge, r);
+                };
+                for (auto j = std::next(i); j != gi->end(); ++j)
+                    if (not molecule.isPairExcluded(std::distance(gi->begin(), i), std::distance(gi->begin(), j)))
+                        addPair(*j);
+                for (auto gj = std::next(gi); gj != spc.groups.end(); ++gj)
+                    for (auto &j : *gj)
+                        addPair(j);
+            }
+        }
+        site_valid = true;
+    }
+
+    void updateSitePotentials(const std::vector<Site> &old) { // O(N) update per changed particle
+        std::vector<int> changed(old.size());
+        std::transform(old.begin(), old.end(), changed.begin(), [](const Site &s) { return s.index; });
+        std::sort(changed.begin(), changed.end());
+        for (int ig = 0; ig < int(spc.groups.size()); ig++) {
+            auto &g = spc.groups[ig];
+            int first = std::distance(spc.p.begin(), g.begin());
+            for (int l = first; l < first + int(g.size()); l++) {
+                if (std::binary_search(changed.begin(), changed.end(), l))
+                    continue;
+                Site site = {l, ig, spc.p[l].pos, spc.p[l].charge};
+                for (auto &k : old)
+                    if (not(k.group == ig and isPairExcluded(site, k)))
+                        site_phi[l] += pairElectricPotential(spc.p[k.index].charge,
+                                                             spc.geo.vdist(site.pos, spc.p[k.index].pos)) -
+                                       pairElectricPotential(k.charge, spc.geo.vdist(site.pos, k.pos));
+            }
+        }
+        for (auto &k : old) {
+            Site site = {k.index, k.group, spc.p[k.index].pos, spc.p[k.index].charge};
+            site_phi[k.index] = sitePotential(site);
+            site_charge[k.index] = site.charge;
+        }
+    }
+
+    /*
+     * Electrostatic energy of particles whose charges have changed, using the cached potentials.
+     * Contributions to the potentials from the changed particles themselves, with their
+     * accepted charges, are replaced by half the interaction with their current charges:
+     *
+     * u = sum_i q_i (phi_i - sum_j [q_j^accepted - q_j / 2] f(r_ij)), where i,j are changed.
+     */
+    double chargeMoveEnergy(const Change &change) {
+        auto sites = changedSites(change);
+        double u = 0;
+        for (auto &i : sites) {
+            double phi = site_phi[i.index];
+            for (auto &j : sites)
+                if (j.index != i.index and not isPairExcluded(i, j))
+                    phi -= pairElectricPotential(site_charge[j.index] - 0.5 * j.charge, spc.geo.vdist(i.pos, j.pos));
+            u += i.charge * phi;
+        }
+        if (analytic_dV) // only the r^-1 term has changed
+            partial.u1 = u;
+        return u;
+    }
+
+    void configureSitePotentials(const json &j) {
+        site_potential = j.value("site_potential", false);
+        if (site_potential) {
+            if (not Potential::has_electric_potential<Tpairpot>::value)
+                throw std::runtime_error("site_potential requires a pair potential linear in the charges");
+            if (j.count("cutoff_g2g") > 0)
+                throw std::runtime_error("site_potential cannot be combined with cutoff_g2g");
+        }
+    }
+
+    void configureAnalyticVolumeScaling(const json &j) {
+        analytic_dV = j.value("analytic_dV", false);
+        if (analytic_dV) {
+            if (not Potential::is_decomposable<Tpairpot>::value)
+                throw std::runtime_error("analytic_dV requires pair potentials with inverse powers of r, only");
+            if (omp_enable)
+                throw std::runtime_error("analytic_dV cannot be combined with openmp");
+            for (auto &g : spc.groups)
+                if (not g.atomic)
+                    throw std::runtime_error("analytic_dV requires atomic groups, only");
+        }
+    }
+
   protected:
     typedef typename Space::Tgroup Tgroup;
     double Rc2_g2g = pc::infty;
@@ -391,8 +606,20 @@ template <typename Tpairpot> class Nonbonded : public Energybase {
     bool omp_g2g = false;
     bool omp_p2p = false;
 
+    // scratch buffers reused between calls to `energy()` to avoid heap allocation in every move
+    Change::Tindex ifiltered, jfiltered;          //!< Active atoms in changed groups (dN)
+    std::vector<std::pair<int, int>> group_pairs; //!< moved<->static group pairs for OpenMP
+    std::vector<int> moved_index, fixed_index;    //!< Moved and static group indices
+
+    bool analytic_dV = false; //!< Evaluate isotropic volume changes from decomposed energy sums
+    bool site_potential = false; //!< Cache the electric potential at each particle for charge moves
+
     void to_json(json &j) const override {
         j["pairpot"] = pairpot;
+        if (analytic_dV and not dV_analytic.empty())
+            j["analytic_dV"] = {{"fraction", dV_analytic.avg()}};
+        if (site_potential)
+            j["site_potential"] = true;
         if (omp_enable) {
             json _a = json::array();
             if (omp_p2p)
@@ -421,9 +648,16 @@ template <typename Tpairpot> class Nonbonded : public Energybase {
         return true;
     } //!< true if group<->group interaction can be skipped
 
-    template <typename T> inline double i2i(const T &a, const T &b) {
+    template <typename T> inline double i2i(const T &a, const T &b) { return i2i(spc.geo, a, b); }
+
+    /*
+     * Particle-particle energy using a minimum image distance policy, see `Geometry::Chameleon::dispatch()`
+     */
+    template <typename Tdistance, typename T> inline double i2i(const Tdistance &distance, const T &a, const T &b) {
         assert(&a != &b && "a and b cannot be the same particle");
-        return pairpot(a, b, spc.geo.vdist(a.pos, b.pos));
+        if (analytic_dV)
+            return decomposedPairEnergy(a, b, distance.vdist(a.pos, b.pos), Potential::is_decomposable<Tpairpot>());
+        return pairpot(a, b, distance.vdist(a.pos, b.pos));
     }
 
     /*
@@ -431,7 +665,12 @@ template <typename Tpairpot> class Nonbonded : public Energybase {
      * is given, only a subset. Index specifies the internal index (starting
      * from zero) of changed particles within the group.
      */
-    double g_internal(const Tgroup &g, const std::vector<int> &index = std::vector<int>()) {
+    double g_internal(const Tgroup &g, const Change::Tindex &index = Change::Tindex()) {
+        return spc.geo.dispatch([&](const auto &distance) { return this->_g_internal(distance, g, index); });
+    }
+
+    template <typename Tdistance>
+    double _g_internal(const Tdistance &distance, const Tgroup &g, const Change::Tindex &index) {
         using namespace ranges;
         double u = 0;
         auto &molecule = molecules.at(g.id);
@@ -441,7 +680,7 @@ template <typename Tpairpot> class Nonbonded : public Energybase {
                 for (auto particle_j = std::next(particle_i); particle_j != g.end(); ++particle_j) {
                     int j = std::distance(g.begin(), particle_j);
                     if (!molecule.isPairExcluded(i, j)) {
-                        u += i2i(*particle_i, *particle_j);
+                        u += i2i(distance, *particle_i, *particle_j);
                     }
                 }
             }
@@ -451,7 +690,7 @@ template <typename Tpairpot> class Nonbonded : public Energybase {
             for (int i : index) {
                 for (int j : fixed) { // moved<->static
                     if (!molecule.isPairExcluded(i, j)) {
-                        u += i2i(*(g.begin() + i), *(g.begin() + j));
+                        u += i2i(distance, *(g.begin() + i), *(g.begin() + j));
                     }
                 }
                 for (int j : index) { // moved<->moved
@@ -459,7 +698,7 @@ template <typename Tpairpot> class Nonbonded : public Energybase {
                         continue;
                     }
                     if (!molecule.isPairExcluded(i, j)) {
-                        u += i2i(*(g.begin() + i), *(g.begin() + j));
+                        u += i2i(distance, *(g.begin() + i), *(g.begin() + j));
                     }
                 }
             }
@@ -476,6 +715,10 @@ template <typename Tpairpot> class Nonbonded : public Energybase {
         if (omp_enable and omp_i2all) {
             return i2all_parallel(i);
         }
+        return spc.geo.dispatch([&](const auto &distance) { return this->_i2all(distance, i); });
+    }
+
+    template <typename Tdistance> double _i2all(const Tdistance &distance, const typename Space::Tparticle &i) {
         double u = 0;
         auto it = spc.findGroupContaining(i); // iterator to group
         if (it != spc.groups.end()) {         // check if i belongs to group in space
@@ -484,14 +727,14 @@ template <typename Tpairpot> class Nonbonded : public Energybase {
                 if (&g != &(*it))         // avoid self-interaction
                     if (not cut(g, *it))  // check g2g cut-off
                         for (auto &j : g) // loop over particles in other group
-                            u += i2i(i, j);
+                            u += i2i(distance, i, j);
             }
-            std::ptrdiff_t i_ndx = &i - &(*(it->begin()));   // fixme c++ style
-            u += g_internal(*it, {static_cast<int>(i_ndx)}); // only int indices are used internally
+            std::ptrdiff_t i_ndx = &i - &(*(it->begin()));              // fixme c++ style
+            u += _g_internal(distance, *it, {static_cast<int>(i_ndx)}); // only int indices are used internally
         } else {                          // particle does not belong to any group
             for (auto &g : spc.groups) {  // i with all other *active* particles
                 for (auto &j : g) {       // (this will include only active particles)
-                    u += i2i(i, j);
+                    u += i2i(distance, i, j);
                 }
             }
         }
@@ -500,7 +743,6 @@ template <typename Tpairpot> class Nonbonded : public Energybase {
 
     double i2all_parallel(const typename Space::Tparticle &i) {
         i_interact_with_these.clear();
-        double u = 0;
         auto it = spc.findGroupContaining(i); // iterator to group
         if (it != spc.groups.end()) {         // check if i belongs to group in space
             for (size_t ig = 0; ig < spc.groups.size(); ig++) {
@@ -517,10 +759,13 @@ template <typename Tpairpot> class Nonbonded : public Energybase {
             for (auto &g : spc.groups)                   // i with all other *active* particles
                 for (auto &j : g)                        // (this will include only active particles)
                     i_interact_with_these.push_back(&j); // u += i2i(i, j);
+        return spc.geo.dispatch([&](const auto &distance) {
+            double u = 0;
 #pragma omp parallel for reduction(+ : u) if (omp_enable and omp_i2all)
-        for (size_t k = 0; k < i_interact_with_these.size(); k++)
-            u += i2i(i, *i_interact_with_these[k]);
-        return u;
+            for (size_t k = 0; k < i_interact_with_these.size(); k++)
+                u += this->i2i(distance, i, *i_interact_with_these[k]);
+            return u;
+        });
     }
 
     /*
@@ -531,28 +776,34 @@ template <typename Tpairpot> class Nonbonded : public Energybase {
      * hence excluding !sub1 <-> !sub2 in comparision to calling onconstrained g2g. In absence
      * of sub1 any sub2 is ignored.
      */
-    virtual double g2g(const Tgroup &g1, const Tgroup &g2, const std::vector<int> &index = std::vector<int>(),
-                       const std::vector<int> &jndex = std::vector<int>()) {
+    virtual double g2g(const Tgroup &g1, const Tgroup &g2, const Change::Tindex &index = Change::Tindex(),
+                       const Change::Tindex &jndex = Change::Tindex()) {
+        if (cut(g1, g2))
+            return 0;
+        return spc.geo.dispatch([&](const auto &distance) { return this->_g2g(distance, g1, g2, index, jndex); });
+    }
+
+    template <typename Tdistance>
+    double _g2g(const Tdistance &distance, const Tgroup &g1, const Tgroup &g2, const Change::Tindex &index,
+                const Change::Tindex &jndex) {
         using namespace ranges;
         double u = 0;
-        if (not cut(g1, g2)) {
-            if (index.empty() && jndex.empty()) // if index is empty, assume all in g1 have changed
+        if (index.empty() && jndex.empty()) // if index is empty, assume all in g1 have changed
 #pragma omp parallel for reduction(+ : u) schedule(dynamic) if (omp_enable and omp_p2p)
-                for (size_t i = 0; i < g1.size(); i++)
-                    for (size_t j = 0; j < g2.size(); j++)
-                        u += i2i(*(g1.begin() + i), *(g2.begin() + j));
-            else { // only a subset of g1
-                for (auto i : index)
-                    for (auto j = g2.begin(); j != g2.end(); ++j)
-                        u += i2i(*(g1.begin() + i), *j);
-                if (not jndex.empty()) {
-                    auto fixed = view::ints(0, int(g1.size())) | view::remove_if([&index](int i) {
-                                     return std::binary_search(index.begin(), index.end(), i);
-                                 });
-                    for (auto i : jndex)     // moved2        <-|
-                        for (auto j : fixed) // static1   <-|
-                            u += i2i(*(g2.begin() + i), *(g1.begin() + j));
-                }
+            for (size_t i = 0; i < g1.size(); i++)
+                for (size_t j = 0; j < g2.size(); j++)
+                    u += i2i(distance, *(g1.begin() + i), *(g2.begin() + j));
+        else { // only a subset of g1
+            for (auto i : index)
+                for (auto j = g2.begin(); j != g2.end(); ++j)
+                    u += i2i(distance, *(g1.begin() + i), *j);
+            if (not jndex.empty()) {
+                auto fixed = view::ints(0, int(g1.size())) | view::remove_if([&index](int i) {
+                                 return std::binary_search(index.begin(), index.end(), i);
+                             });
+                for (auto i : jndex)     // moved2        <-|
+                    for (auto j : fixed) // static1   <-|
+                        u += i2i(distance, *(g2.begin() + i), *(g1.begin() + j));
             }
         }
         return u;
@@ -590,6 +841,19 @@ template <typename Tpairpot> class Nonbonded : public Energybase {
     BasePointerVector<Energybase> &pot;
     Tpairpot pairpot; //!< Pair potential
 
+    /**
+     * The pair potential is probed for all atom types at a few distances beyond `distance`.
+     * This detects missing or too long cutoffs, assuming the potential is zero beyond its cutoff.
+     */
+    bool interactsBeyond(double distance) const override {
+        for (auto &i : atoms)
+            for (auto &j : atoms)
+                for (double scale : {1.001, 1.5, 2.0, 4.0})
+                    if (pairpot(Particle(i), Particle(j), {scale * distance, 0, 0}) != 0)
+                        return true;
+        return false;
+    }
+
     Nonbonded(const json &j, Space &spc, BasePointerVector<Energybase> &pot) : spc(spc), pot(pot) {
         name = "nonbonded";
         pairpot.from_json(j);
@@ -599,6 +863,8 @@ template <typename Tpairpot> class Nonbonded : public Energybase {
         addPairPotentialSelfEnergy();
 
         configureOpenMP(j);
+        configureAnalyticVolumeScaling(j);
+        configureSitePotentials(j);
 
         // disable all group-to-group cutoffs by setting infinity
         for (auto &i : Faunus::molecules)
@@ -651,13 +917,50 @@ template <typename Tpairpot> class Nonbonded : public Energybase {
         }
     }
 
+    void init() override {
+        if (site_potential)
+            updateSitePotentials();
+        if (analytic_dV)
+            sums_box.setZero(); // configuration may have been replaced; rebuilt by next full energy
+    }
+
     double energy(Change &change) override {
         using namespace ranges;
         double u = 0;
 
+        if (analytic_dV) {
+            partial = Potential::InversePowerSums();
+            partial_change = &change;
+            partial_all = change.dV or change.all;
+        }
+
+        if (site_potential and change) {
+            if (key == OLD) { // keep old state of changed particles to update potentials if accepted
+                site_pending.clear();
+                if (not(change.dV or change.all or change.dN))
+                    site_pending = changedSites(change);
+                site_change = &change;
+            }
+            // only charges have changed; positions and the number of particles are untouched
+            if (change.chargeMove and site_valid and not(change.dV or change.all or change.dN))
+                return chargeMoveEnergy(change);
+        }
+
         if (change) {
             // there's a change in system volume
             if (change.dV) {
+                if (analytic_dV) { // O(1) energy if isotropically scaled and no pair crosses a cut-off
+                    double s = isotropicScaling();
+                    if (s > 0) {
+                        u = sums.energy(s);
+                        if (key == NEW)
+                            dV_analytic += std::isnan(u) ? 0 : 1;
+                        if (not std::isnan(u)) {
+                            partial = sums.scale(s);
+                            return u;
+                        }
+                    }
+                }
 #pragma omp parallel for reduction(+ : u) schedule(dynamic) if (omp_enable and omp_g2g)
                 for (auto i = spc.groups.begin(); i < spc.groups.end(); ++i) {
                     for (auto j = i; ++j != spc.groups.end();)
@@ -703,10 +1006,13 @@ template <typename Tpairpot> class Nonbonded : public Energybase {
                 return u;
             }
 
-            auto moved = change.touchedGroupIndex(); // index of moved groups
-            auto fixed = view::ints(0, int(spc.groups.size())) | view::remove_if([&moved](int i) {
-                             return std::binary_search(moved.begin(), moved.end(), i);
-                         }); // index of static groups
+            auto &moved = moved_index; // index of moved groups
+            change.touchedGroupIndex(moved);
+            auto &fixed = fixed_index; // index of static groups
+            fixed.clear();
+            for (int i = 0; i < int(spc.groups.size()); i++)
+                if (not std::binary_search(moved.begin(), moved.end(), i))
+                    fixed.push_back(i);
 
             if (change.dN) {
                 /*auto moved = change.touchedGroupIndex(); // index of moved groups
@@ -720,8 +1026,9 @@ template <typename Tpairpot> class Nonbonded : public Energybase {
                             [&Moved](int i){return std::binary_search(Moved.begin(), Moved.end(), i);}
                             ); // index of static groups*/
                 for (auto cg1 = change.groups.begin(); cg1 < change.groups.end();
-                     ++cg1) {                              // Loop over all changed groups
-                    std::vector<int> ifiltered, jfiltered; // Active atoms
+                     ++cg1) { // Loop over all changed groups
+                    ifiltered.clear();
+                    jfiltered.clear();
                     auto g1 = &spc.groups.at(cg1->index);
                     for (auto i : cg1->atoms) {
                         if (i < g1->size())
@@ -760,14 +1067,14 @@ template <typename Tpairpot> class Nonbonded : public Energybase {
 
             // moved<->static
             if (omp_enable and omp_g2g) {
-                std::vector<std::pair<int, int>> pairs(size(moved) * size(fixed));
+                group_pairs.resize(size(moved) * size(fixed));
                 size_t cnt = 0;
                 for (auto i : moved)
                     for (auto j : fixed)
-                        pairs[cnt++] = {i, j};
+                        group_pairs[cnt++] = {i, j};
 #pragma omp parallel for reduction(+ : u) schedule(dynamic) if (omp_enable and omp_g2g)
-                for (size_t i = 0; i < pairs.size(); i++)
-                    u += g2g(spc.groups[pairs[i].first], spc.groups[pairs[i].second]);
+                for (size_t i = 0; i < group_pairs.size(); i++)
+                    u += g2g(spc.groups[group_pairs[i].first], spc.groups[group_pairs[i].second]);
             } else
                 for (auto i : moved)
                     for (auto j : fixed)
@@ -778,6 +1085,71 @@ template <typename Tpairpot> class Nonbonded : public Energybase {
         return u;
     }
 
+    /*
+     * With analytic volume scaling, the decomposed energy sums of the accepted state
+     * are updated from the pairs visited by `energy()` in both states, using the same
+     * `change`, and copied to the other state which hence is modified as well.
+     * Likewise, cached site potentials are updated upon acceptance and copied to the other state.
+     */
+    void sync(Energybase *basePtr, Change &change) override {
+        auto other = dynamic_cast<decltype(this)>(basePtr);
+        assert(other);
+        if (site_potential and key == OLD and change) { // accepted
+            if (change.dN and not site_rebuild_warned) {
+                // inserting or deleting rearranges particles within groups which invalidates the indexing
+                faunus_logger->warn("{}: site potentials are rebuilt in O(N^2) for every accepted change in "
+                                    "the number of particles",
+                                    name);
+                site_rebuild_warned = true;
+            }
+            if (change.dV or change.all or change.dN or site_change != &change)
+                updateSitePotentials();
+            else
+                updateSitePotentials(site_pending);
+            other->site_phi = site_phi;
+            other->site_charge = site_charge;
+            other->site_valid = site_valid;
+            site_change = nullptr;
+        }
+        if (analytic_dV) {
+            if (other->partial_change == &change and other->partial_all) { // other holds the full system
+                sums = other->partial;
+                sums_box = other->spc.geo.getLength();
+            } else if (key == OLD and change) { // accepted: replace pairs in this state w. those from the other
+                if (partial_change == &change and other->partial_change == &change)
+                    sums.update(partial, other->partial);
+                else
+                    sums_box.setZero(); // energy() was skipped in either state (maxenergy); invalidate
+            } else { // rejected
+                sums = other->sums;
+                sums_box = other->sums_box;
+            }
+            other->sums = sums;
+            other->sums_box = sums_box;
+            partial_change = other->partial_change = nullptr;
+        }
+    }
+
+    /*
+     * Unlike `sync()`, this leaves `other` untouched so that several replicas may copy from it
+     * concurrently. Site potentials and decomposed sums of `other` are valid for its accepted state.
+     */
+    void copyFrom(const Energybase &base) override {
+        auto other = dynamic_cast<const Nonbonded *>(&base);
+        assert(other);
+        if (site_potential) {
+            site_phi = other->site_phi;
+            site_charge = other->site_charge;
+            site_valid = other->site_valid;
+            site_change = nullptr;
+        }
+        if (analytic_dV) {
+            sums = other->sums;
+            sums_box = other->sums_box;
+            partial_change = nullptr;
+        }
+    }
+
 }; //!< Nonbonded, pair-wise additive energy term
 
 template <typename Tpairpot> class NonbondedCached : public Nonbonded<Tpairpot> {
@@ -788,8 +1160,8 @@ template <typename Tpairpot> class NonbondedCached : public Nonbonded<Tpairpot>
     Space &spc;
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
-    double g2g(const Tgroup &g1, const Tgroup &g2, const std::vector<int> &index = std::vector<int>(),
-               const std::vector<int> &jndex = std::vector<int>()) override {
+    double g2g(const Tgroup &g1, const Tgroup &g2, const Change::Tindex &index = Change::Tindex(),
+               const Change::Tindex &jndex = Change::Tindex()) override {
 #pragma GCC diagnostic pop
         //assert(index.empty() && "unimplemented");
         //assert(jndex.empty() && "unimplemented");
@@ -813,6 +1185,8 @@ template <typename Tpairpot> class NonbondedCached : public Nonbonded<Tpairpot>
   public:
     NonbondedCached(const json &j, Space &spc, BasePointerVector<Energybase> &pot) : base(j, spc, pot), spc(spc) {
         base::name += "EM";
+        if (base::analytic_dV or base::site_potential)
+            throw std::runtime_error("analytic_dV and site_potential are unavailable for cached energies");
         init();
     }
 
@@ -865,10 +1239,13 @@ template <typename Tpairpot> class NonbondedCached : public Nonbonded<Tpairpot>
                 return u;
             }
 
-            auto moved = change.touchedGroupIndex(); // index of moved groups
-            auto fixed = view::ints(0, int(base::spc.groups.size())) | view::remove_if([&moved](int i) {
-                             return std::binary_search(moved.begin(), moved.end(), i);
-                         }); // index of static groups
+            auto &moved = this->moved_index; // index of moved groups
+            change.touchedGroupIndex(moved);
+            auto &fixed = this->fixed_index; // index of static groups
+            fixed.clear();
+            for (int i = 0; i < int(base::spc.groups.size()); i++)
+                if (not std::binary_search(moved.begin(), moved.end(), i))
+                    fixed.push_back(i);
 
             // moved<->moved
             if (change.moved2moved)
@@ -877,14 +1254,14 @@ template <typename Tpairpot> class NonbondedCached : public Nonbonded<Tpairpot>
                         u += g2g(base::spc.groups[*i], base::spc.groups[*j]);
             // moved<->static
             if (this->omp_enable and this->omp_g2g) {
-                std::vector<std::pair<int, int>> pairs(size(moved) * size(fixed));
+                this->group_pairs.resize(size(moved) * size(fixed));
                 size_t cnt = 0;
                 for (auto i : moved)
                     for (auto j : fixed)
-                        pairs[cnt++] = {i, j};
+                        this->group_pairs[cnt++] = {i, j};
 #pragma omp parallel for reduction(+ : u) schedule(dynamic) if (this->omp_enable and this->omp_g2g)
-                for (size_t i = 0; i < pairs.size(); i++)
-                    u += g2g(spc.groups[pairs[i].first], spc.groups[pairs[i].second]);
+                for (size_t i = 0; i < this->group_pairs.size(); i++)
+                    u += g2g(spc.groups[this->group_pairs[i].first], spc.groups[this->group_pairs[i].second]);
             } else
                 for (auto i : moved)
                     for (auto j : fixed)
@@ -909,6 +1286,8 @@ template <typename Tpairpot> class NonbondedCached : public Nonbonded<Tpairpot>
                     cache(d.index, i) = other->cache(d.index, i);
             }
     } //!< Copy energy matrix from other
+
+    void copyFrom(const Energybase &other) override { Energybase::copyFrom(other); } // sync() only reads other
 };    //!< Nonbonded with cached energies (Energy Matrix)
 
 #ifdef ENABLE_FREESASA
@@ -924,6 +1303,7 @@ class SASAEnergy : public Energybase {
   private:
     Space &spc;
     double cosolute_concentration;             // co-solute concentration (mol/l)
+    std::vector<double> tension, tfe;          // per atom type in kT at construction temperature
     freesasa_parameters parameters;
     Average<double> avgArea; // average surface area
 
@@ -953,16 +1333,63 @@ struct Example2D : public Energybase {
     double energy(Change &change) override;
 };
 
+/**
+ * @brief Running energy of each term in a Hamiltonian
+ *
+ * Starting from a full evaluation, energy changes of accepted moves are
+ * added term by term so that the current energy is available without
+ * recomputation. The ledger becomes invalid if a change is not finite
+ * (infinite or NaN energies) and must then be reset from a full evaluation.
+ */
+class EnergyLedger {
+    std::vector<double> u; // running energy of each term
+    bool valid = false;
+
+  public:
+    void reset(const std::vector<double> &energies); //!< Set from full evaluation of all terms
+    void accept(const std::vector<double> &unew,
+                const std::vector<double> &uold); //!< Add change of accepted move (term by term)
+    void invalidate() { valid = false; }          //!< Mark as out of sync with the system
+    bool isValid() const { return valid; }        //!< True if in sync with the system
+    const std::vector<double> &energies() const { return u; }                  //!< Energy of each term
+    double total() const { return std::accumulate(u.begin(), u.end(), 0.0); } //!< Total energy
+};
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+TEST_CASE("[Faunus] EnergyLedger") {
+    using doctest::Approx;
+    EnergyLedger ledger;
+    CHECK(not ledger.isValid());
+    ledger.reset({1.0, 2.0});
+    CHECK(ledger.isValid());
+    ledger.accept({0.5, 4.0}, {1.0, 3.0}); // term changes -0.5 and +1
+    CHECK(ledger.energies()[0] == Approx(0.5));
+    CHECK(ledger.total() == Approx(3.5));
+    ledger.accept({std::numeric_limits<double>::quiet_NaN(), 0.0}, {0.0, 0.0}); // term not evaluated
+    CHECK(not ledger.isValid());
+    ledger.reset({pc::infty, 0.0});
+    CHECK(not ledger.isValid());
+}
+#endif
+
 class Hamiltonian : public Energybase, public BasePointerVector<Energybase> {
+  private:
+    json input; //!< Input used for construction; kept to create replicas
   protected:
     double maxenergy = pc::infty; //!< Maximum allowed energy change
     void to_json(json &j) const override;
     void addEwald(const json &j, Space &spc); //!< Adds an instance of reciprocal space Ewald energies (if appropriate)
   public:
+    std::vector<double> term_energies; //!< Energy of each term from last `energy()` call; NaN if not evaluated
+    EnergyLedger ledger;               //!< Running energy of accepted configurations (maintained by the caller)
     Hamiltonian(Space &spc, const json &j);
+    std::shared_ptr<Hamiltonian> replica(Space &spc) const; //!< Independent copy operating on another space
+    void reset(Space &spc, const json &j);                  //!< Replace all terms by those given in `j`
+    void copyState(const Hamiltonian &other);               //!< Copy state of all terms, leaving `other` untouched
     double energy(Change &change) override; //!< Energy due to changes
     void init() override;
     void sync(Energybase *basePtr, Change &change) override;
+    bool interactsBeyond(double distance) const override;
 }; //!< Aggregates and sum energy terms
 
 } // namespace Energy
@@ -55,5 +55,20 @@ TEST_CASE( "[Faunus] FreeSASA") {
 }
 #endif
 
+TEST_CASE("[Faunus] Hamiltonian::interactsBeyond") {
+    atoms = R"([{ "A": { "sigma": 2.0, "eps": 0.5 } }])"_json.get<decltype(atoms)>();
+    molecules = R"([{ "M": { "atoms": ["A"], "atomic": true } }])"_json.get<decltype(molecules)>();
+    Space spc = R"({
+        "geometry": {"type": "cuboid", "length": [10, 10, 10]},
+        "insertmolecules": [ { "M": { "N": 2 } } ]
+    })"_json;
+    Energy::Hamiltonian wca(spc, R"([{ "nonbonded": { "default": [{ "wca": {"mixing": "LB"} }] } }])"_json);
+    CHECK(wca.interactsBeyond(2.0));     // inside 2^(1/6) sigma
+    CHECK(not wca.interactsBeyond(2.5)); // beyond
+    Energy::Hamiltonian lj(spc, R"([{ "nonbonded": { "default": [{ "lennardjones": {"mixing": "LB"} }] } }])"_json);
+    CHECK(lj.interactsBeyond(100.0)); // no cutoff
+    CHECK(not Energy::Hamiltonian(spc, json::array()).interactsBeyond(0.0));
+}
+
 TEST_SUITE_END();
 } // namespace Faunus
@@ -14,8 +14,27 @@ void Energybase::to_json(json &) const {}
 
 void Energybase::sync(Energybase *, Change &) {}
 
+/**
+ * The default syncs as a trial (NEW) state after a rejected move, i.e. everything is copied
+ * from `other`. This requires that `sync()` only reads `other` and terms where this is not
+ * the case must override this function.
+ */
+void Energybase::copyFrom(const Energybase &other) {
+    static Change change = []() {
+        Change c;
+        c.all = true;
+        return c;
+    }(); // unique address; terms identify energy evaluations by the address of the change object
+    auto oldkey = key;
+    key = NEW;
+    sync(const_cast<Energybase *>(&other), change);
+    key = oldkey;
+}
+
 void Energybase::init() {}
 
+bool Energybase::interactsBeyond(double) const { return false; }
+
 void to_json(json &j, const Energybase &base) {
     assert(not base.name.empty());
     if (base.timer)
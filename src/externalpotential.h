@@ -26,7 +26,9 @@ class Energybase {
     virtual double energy(Change &) = 0;                  //!< energy due to change
     virtual void to_json(json &j) const;                  //!< json output
     virtual void sync(Energybase *, Change &);
+    virtual void copyFrom(const Energybase &other); //!< Copy state from `other` without modifying it
     virtual void init();                               //!< reset and initialize
+    virtual bool interactsBeyond(double distance) const; //!< True if particles further apart may interact
     virtual inline void force(std::vector<Point> &){}; // update forces on all particles
     inline virtual ~Energybase(){};
 };
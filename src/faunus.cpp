@@ -2,6 +2,7 @@
 #include "mpicontroller.h"
 #include "move.h"
 #include "montecarlo.h"
+#include "context.h"
 #include "analysis.h"
 #include "docopt.h"
 #include "progress_tracker.h"
@@ -10,7 +11,11 @@
 #include <spdlog/sinks/null_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <iomanip>
+#include <atomic>
 #include <unistd.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #ifdef ENABLE_SID
 #include "cppsid.h"
@@ -39,14 +44,17 @@ static const char USAGE[] =
     http://github.com/mlund/faunus
 
     Usage:
-      faunus [-q] [--verbosity <N>] [--nobar] [--nopfx] [--notips] [--nofun] [--state=<file>] [--input=<file>] [--output=<file>]
+      faunus [-q] [--verbosity <N>] [--nobar] [--nopfx] [--notips] [--nofun] [--state=<file>] [--input=<file>] [--output=<file>] [--replicas=<N>] [--rerun=<file>] [--threads=<N>]
       faunus (-h | --help)
       faunus --version
 
     Options:
       -i <file> --input <file>   Input file [default: /dev/stdin].
       -o <file> --output <file>  Output file [default: out.json].
-      -s <file> --state <file>   State file to start from (.json/.ubj).
+      -s <file> --state <file>   State file to start from (.json/.ubj/.ckpt).
+      -r <N> --replicas <N>      Number of replicas run as threads [default: 1].
+      --rerun <file>             Analyse xtc trajectory instead of running MC.
+      --threads <N>              Threads used by --rerun; 0 = all available [default: 0].
       -v <N> --verbosity <N>     Log verbosity level (0 = off, 1 = critical, ..., 6 = trace) [default: 4]
       -q --quiet                 Less verbose output. It implicates -v0 --nobar --notips --nofun.
       -h --help                  Show this screen.
@@ -61,12 +69,21 @@ static const char USAGE[] =
     1. input and output files are prefixed with "mpi{rank}."
     2. standard output is redirected to "mpi{rank}.stdout"
     3. Input prefixing can be suppressed with --nopfx
+
+    Multiple replicas using threads (--replicas):
+
+    1. input and output files are prefixed with "replica{index}."
+    2. topology is read once and shared by all replicas
+    3. configurations are exchanged between neighboring replicas after each macro step
 )";
 
 using ProgressIndicator::ProgressTracker;
 
 // forward declarations
 std::shared_ptr<ProgressTracker> createProgressTracker(bool, unsigned int);
+void saveOutput(const std::string &, MCSimulation &, Analysis::CombinedAnalysis &);
+void saveRerunOutput(const std::string &, const std::string &, size_t, Analysis::CombinedAnalysis &);
+void runReplicas(int, const std::string &, const std::string &);
 
 int main(int argc, char **argv) {
     using namespace Faunus::MPI;
@@ -128,6 +145,21 @@ int main(int argc, char **argv) {
         // --nopfx
         bool prefix = !args["--nopfx"].asBool();
 
+        // --replicas
+        int replicas = std::stoi(args["--replicas"].asString());
+        if (replicas > 1) {
+#ifdef ENABLE_MPI
+            // moves and analyses use the process wide MPI controller (random numbers, collective
+            // calls) which cannot be shared by concurrently running replicas
+            throw std::runtime_error("replicas cannot be used in MPI builds; use parallel tempering instead");
+#endif
+            if (args["--state"] or args["--rerun"] or args["--input"].asString() == "/dev/stdin")
+                throw std::runtime_error("replicas require input files and no state or trajectory file");
+            runReplicas(replicas, args["--input"].asString(), args["--output"].asString());
+            mpi.finalize();
+            return EXIT_SUCCESS;
+        }
+
         // --input
         json json_in;
         auto input = args["--input"].asString();
@@ -153,31 +185,53 @@ int main(int argc, char **argv) {
                 auto mode = std::ios::in;
                 if (binary)
                     mode = std::ifstream::ate | std::ios::binary; // ate = open at end
-                f.open(state, mode);
-                if (f) {
-                    json json_state;
-                    faunus_logger->info("loading state file {}", state);
-                    if (binary) {
-                        size_t size = f.tellg(); // get file size
-                        std::vector<std::uint8_t> v(size / sizeof(std::uint8_t));
-                        f.seekg(0, f.beg); // go back to start
-                        f.read((char *)v.data(), size);
-                        json_state = json::from_ubjson(v);
+                if (suffix == "ckpt") { // native binary checkpoint
+                    faunus_logger->info("loading checkpoint {}", state);
+                    sim.restore(state);
+                } else {
+                    f.open(state, mode);
+                    if (f) {
+                        json json_state;
+                        faunus_logger->info("loading state file {}", state);
+                        if (binary) {
+                            size_t size = f.tellg(); // get file size
+                            std::vector<std::uint8_t> v(size / sizeof(std::uint8_t));
+                            f.seekg(0, f.beg); // go back to start
+                            f.read((char *)v.data(), size);
+                            json_state = json::from_ubjson(v);
+                        } else {
+                            f >> json_state;
+                        }
+                        sim.restore(json_state);
                     } else {
-                        f >> json_state;
+                        throw std::runtime_error("state file error: " + state);
                     }
-                    sim.restore(json_state);
-                } else {
-                    throw std::runtime_error("state file error: " + state);
                 }
             }
 
-            Analysis::CombinedAnalysis analysis(json_in.at("analysis"), sim.space(), sim.pot());
+            // --rerun
+            if (args["--rerun"]) {
+                std::string trajectory = Faunus::MPI::prefix + args["--rerun"].asString();
+                Analysis::TrajectoryRerun rerun(json_in.at("analysis"), sim.space(), sim.pot(),
+                                                std::stoi(args["--threads"].asString()));
+                faunus_logger->info("analysing trajectory {}", trajectory);
+                size_t frames = rerun.run(trajectory);
+                faunus_logger->info("analysed {} frames", frames);
+                saveRerunOutput(Faunus::MPI::prefix + args["--output"].asString(), trajectory, frames,
+                                rerun.analysis());
+                mpi.finalize();
+                return EXIT_SUCCESS;
+            }
 
             auto &loop = json_in.at("mcloop");
             int macro = loop.at("macro");
             int micro = loop.at("micro");
 
+            // one set of analyses per thermodynamic state if labels are exchanged (demultiplexing)
+            Analysis::LabelledAnalysis analysis(json_in.at("analysis"), sim.space(), sim.pot(),
+                                                loop.value("analysis_queue", 0));
+            analysis[sim.label()]; // create analyses of initial label up front to catch input errors
+
             auto progress_tracker = createProgressTracker(show_progress, macro * micro);
             for (int i = 0; i < macro; i++) {
                 for (int j = 0; j < micro; j++) {
@@ -187,7 +241,7 @@ int main(int argc, char **argv) {
                         }
                     }
                     sim.move();
-                    analysis.sample();
+                    analysis.sample(sim.label());
                 }
             }
             if (progress_tracker && mpi.isMaster()) {
@@ -198,23 +252,9 @@ int main(int argc, char **argv) {
                                "relative drift = {}", sim.drift());
 
             // --output
-            std::ofstream f(Faunus::MPI::prefix + args["--output"].asString());
-            if (f) {
-                json json_out;
-                Faunus::to_json(json_out, sim);
-                json_out["relative drift"] = sim.drift();
-                json_out["analysis"] = analysis;
-                if (mpi.nproc() > 1) {
-                    json_out["mpi"] = mpi;
-                }
-#ifdef GIT_COMMIT_HASH
-                json_out["git revision"] = GIT_COMMIT_HASH;
-#endif
-#ifdef __VERSION__
-                json_out["compiler"] = __VERSION__;
-#endif
-                f << std::setw(4) << json_out << endl;
-            }
+            for (auto &label : analysis.labels)
+                saveOutput(Faunus::MPI::prefix + analysis.prefix(label.first) + args["--output"].asString(), sim,
+                           *label.second);
         }
 
         mpi.finalize();
@@ -306,6 +346,147 @@ std::shared_ptr<CPPSID::Player> createLoadedSIDplayer() {
 }
 #endif
 
+void saveOutput(const std::string &file, MCSimulation &sim, Analysis::CombinedAnalysis &analysis) {
+    analysis.flush(); // wait for pending asynchronous analysis
+    double drift = sim.drift(); // collective for domain decomposition; call on all ranks
+    std::ofstream f(file);
+    if (f) {
+        json json_out;
+        Faunus::to_json(json_out, sim);
+        json_out["relative drift"] = drift;
+        json_out["analysis"] = analysis;
+        if (Faunus::MPI::mpi.nproc() > 1) {
+            json_out["mpi"] = Faunus::MPI::mpi;
+        }
+#ifdef GIT_COMMIT_HASH
+        json_out["git revision"] = GIT_COMMIT_HASH;
+#endif
+#ifdef __VERSION__
+        json_out["compiler"] = __VERSION__;
+#endif
+        f << std::setw(4) << json_out << endl;
+    }
+}
+
+void saveRerunOutput(const std::string &file, const std::string &trajectory, size_t frames,
+                     Analysis::CombinedAnalysis &analysis) {
+    std::ofstream f(file);
+    if (f) {
+        json json_out;
+        json_out["rerun"] = {{"trajectory", trajectory}, {"frames", frames}};
+        json_out["analysis"] = analysis;
+#ifdef GIT_COMMIT_HASH
+        json_out["git revision"] = GIT_COMMIT_HASH;
+#endif
+#ifdef __VERSION__
+        json_out["compiler"] = __VERSION__;
+#endif
+        f << std::setw(4) << json_out << endl;
+    }
+}
+
+/*
+ * Runs replicas as threads, each pinned to a core, within a single process
+ *
+ * Each thread owns a simulation which is constructed from its own input file (prefixed
+ * with "replica{index}."). Random number generators, temperature and the file prefix
+ * are given by an explicit context for each replica, activated in its thread, whereas
+ * the topology (atoms, molecules, reactions) is loaded by the first replica and shared.
+ * Replicas are therefore constructed one at a time. After each macro step, the master
+ * thread attempts configuration exchanges between neighboring replicas (alternating even
+ * and odd pairs) while the other threads wait. For this, the contexts are handed over to the
+ * master thread which evaluates each replica in its own context.
+ */
+void runReplicas(int replicas, const std::string &input, const std::string &output) {
+#ifdef _OPENMP
+    std::vector<std::shared_ptr<MCSimulation>> sims(replicas);
+    std::vector<Context> contexts(replicas); // per replica temperature, prefix and random number generators
+    const Context parent = Context::current();
+    std::vector<Average<double>> acceptance(replicas - 1);
+    Random exchange_random; // used by master thread only
+    std::exception_ptr error = nullptr;
+    std::atomic<bool> failed(false);
+    int macro = -1, micro = -1;
+
+#pragma omp parallel num_threads(replicas) proc_bind(spread)
+    {
+        const int i = omp_get_thread_num();
+        std::shared_ptr<Analysis::CombinedAnalysis> analysis;
+        auto guard = [&](std::function<void()> f) {
+            if (not failed) {
+                try {
+                    f();
+                } catch (...) {
+#pragma omp critical
+                    {
+                        if (not failed)
+                            error = std::current_exception();
+                        failed = true;
+                    }
+                }
+            }
+        };
+
+        for (int k = 0; k < replicas; k++) {
+            if (k == i) {
+                guard([&]() {
+                    auto &context = contexts[i] = parent.stream(i); // independent random numbers
+                    context.prefix = "replica" + std::to_string(i) + ".";
+                    json json_in = openjson(context.prefix + input);
+                    context.temperature = json_in.at("temperature").get<double>() * 1.0_K;
+                    context.activate(); // thread local state used during construction and sampling
+                    sims[i] = std::make_shared<MCSimulation>(json_in, Faunus::MPI::mpi);
+                    auto &loop = json_in.at("mcloop");
+                    analysis = std::make_shared<Analysis::CombinedAnalysis>(json_in.at("analysis"), sims[i]->space(),
+                                                                            sims[i]->pot(),
+                                                                            loop.value("analysis_queue", 0));
+                    if (i == 0) {
+                        macro = loop.at("macro");
+                        micro = loop.at("micro");
+                    } else if (macro != loop.at("macro").get<int>() or micro != loop.at("micro").get<int>())
+                        throw std::runtime_error("all replicas must have identical mcloop");
+                });
+            }
+#pragma omp barrier
+        }
+
+        for (int step = 0; step < macro; step++) {
+            guard([&]() {
+                for (int j = 0; j < micro; j++) {
+                    sims[i]->move();
+                    analysis->sample();
+                }
+            });
+            contexts[i] = Context::current(); // hand over to the master thread for the exchange
+#pragma omp barrier
+#pragma omp master
+            guard([&]() {
+                for (int k = step % 2; k + 1 < replicas; k += 2)
+                    acceptance[k] += sims[k]->exchange(*sims[k + 1], exchange_random, contexts[k], contexts[k + 1]);
+            });
+#pragma omp barrier
+            contexts[i].activate();
+        }
+
+        guard([&]() {
+            faunus_logger->log((sims[i]->drift() < 1E-9) ? spdlog::level::info : spdlog::level::warn,
+                               "replica {} relative drift = {}", i, sims[i]->drift());
+            saveOutput(Faunus::MPI::prefix + output, *sims[i], *analysis);
+        });
+        analysis = nullptr; // analysis may write files and must be destructed in its own thread
+        sims[i] = nullptr;
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+    for (size_t k = 0; k < acceptance.size(); k++)
+        faunus_logger->info("replica exchange {} <-> {}: attempts = {}, acceptance = {}", k, k + 1,
+                            acceptance[k].cnt, acceptance[k].avg());
+#else
+    throw std::runtime_error("replicas require OpenMP");
+#endif
+}
+
 std::shared_ptr<ProgressTracker> createProgressTracker(bool show_progress, unsigned int steps) {
     using namespace ProgressIndicator;
     using namespace std::chrono;
@@ -2,6 +2,7 @@
 #include "atomdata.h"
 #include "random.h"
 #include "aux/eigensupport.h"
+#include <algorithm>
 
 namespace Faunus {
 namespace Geometry {
@@ -10,6 +11,16 @@ namespace Geometry {
 
 GeometryBase::~GeometryBase() = default;
 
+void GeometryBase::batchSqdist(const Point &a, const Point *points, size_t n, double *result) const {
+    for (size_t i = 0; i < n; i++)
+        result[i] = vdist(a, points[i]).squaredNorm();
+}
+
+void GeometryBase::batchBoundary(Point *points, size_t n) const {
+    for (size_t i = 0; i < n; i++)
+        boundary(points[i]);
+}
+
 // =============== GeometryImplementation ===============
 
 GeometryImplementation::~GeometryImplementation() = default;
@@ -137,6 +148,44 @@ void Cuboid::from_json(const json &j) {
 
 void Cuboid::to_json(json &j) const { j = {{"length", box}}; }
 
+/**
+ * Side lengths and their inverses with zeros in non-periodic directions, or directions of zero
+ * length, so that the batched minimum image loops below need no branching on the boundary
+ * conditions and never round infinite or NaN values
+ */
+static std::pair<Point, Point> periodicLength(const Point &box, const BoundaryCondition &boundary_conditions) {
+    Point len, len_inv;
+    for (int i = 0; i < 3; i++) {
+        bool periodic = boundary_conditions.direction[i] == PERIODIC and box[i] > 0;
+        len[i] = periodic ? box[i] : 0.0;
+        len_inv[i] = periodic ? 1.0 / box[i] : 0.0;
+    }
+    return {len, len_inv};
+}
+
+void Cuboid::batchSqdist(const Point &a, const Point *points, size_t n, double *result) const {
+    const auto len = periodicLength(box, boundary_conditions);
+    const Point &l = len.first, &l_inv = len.second;
+    for (size_t i = 0; i < n; i++) {
+        Point distance(a - points[i]);
+        distance.x() -= l.x() * anint(distance.x() * l_inv.x());
+        distance.y() -= l.y() * anint(distance.y() * l_inv.y());
+        distance.z() -= l.z() * anint(distance.z() * l_inv.z());
+        result[i] = distance.squaredNorm();
+    }
+}
+
+void Cuboid::batchBoundary(Point *points, size_t n) const {
+    const auto len = periodicLength(box, boundary_conditions);
+    const Point &l = len.first, &l_inv = len.second;
+    for (size_t i = 0; i < n; i++) {
+        Point &a = points[i];
+        a.x() -= l.x() * anint(a.x() * l_inv.x());
+        a.y() -= l.y() * anint(a.y() * l_inv.y());
+        a.z() -= l.z() * anint(a.z() * l_inv.z());
+    }
+}
+
 // =============== Slit ===============
 
 Slit::Slit(const Point &p) : Tbase(p) {
@@ -214,6 +263,15 @@ void Sphere::from_json(const json &j) { radius = j.at("radius").get<double>(); }
 
 void Sphere::to_json(json &j) const { j = {{"radius", radius}}; }
 
+void Sphere::batchSqdist(const Point &a, const Point *points, size_t n, double *result) const {
+    for (size_t i = 0; i < n; i++)
+        result[i] = (a - points[i]).squaredNorm();
+}
+
+void Sphere::batchBoundary(Point *, size_t) const {
+    // no pbc
+}
+
 // =============== Hypersphere 2D ===============
 
 Hypersphere2d::Hypersphere2d(double radius) : Sphere(radius) { boundary_conditions = BoundaryCondition(NON3D); }
@@ -236,6 +294,10 @@ bool Hypersphere2d::collision(const Point &a) const {
     return collision;
 }
 
+void Hypersphere2d::batchSqdist(const Point &a, const Point *points, size_t n, double *result) const {
+    GeometryBase::batchSqdist(a, points, n, result); // no simple form for the arc length
+}
+
 // =============== Hexagonal Prism ===============
 
 const Eigen::Matrix3d HexagonalPrism::rhombic2cartesian =
@@ -356,6 +418,46 @@ void HexagonalPrism::from_json(const json &j) {
 
 void HexagonalPrism::to_json(json &j) const { j = {{"radius", 0.5 * box.x()}, {"length", box.z()}}; }
 
+/**
+ * The hexagonal lattice is the union of a rectangular lattice with sides `d` and `sqrt(3)d`,
+ * where `d` is the inscribed circle diameter, and the same lattice shifted by half a cell.
+ * The minimum image is the shorter of the two rectangular minimum images which, unlike
+ * `boundary()`, needs no sequential reflections.
+ */
+void HexagonalPrism::batchSqdist(const Point &a, const Point *points, size_t n, double *result) const {
+    const double lx = box.x(), ly = std::sqrt(3.0) * box.x(), lz = box.z();
+    const double lx_inv = 1.0 / lx, ly_inv = 1.0 / ly, lz_inv = 1.0 / lz;
+    for (size_t i = 0; i < n; i++) {
+        Point distance(a - points[i]);
+        double x1 = distance.x() - lx * anint(distance.x() * lx_inv);
+        double y1 = distance.y() - ly * anint(distance.y() * ly_inv);
+        double x2 = distance.x() - 0.5 * lx;
+        double y2 = distance.y() - 0.5 * ly;
+        x2 -= lx * anint(x2 * lx_inv);
+        y2 -= ly * anint(y2 * ly_inv);
+        double z = distance.z() - lz * anint(distance.z() * lz_inv);
+        result[i] = std::min(x1 * x1 + y1 * y1, x2 * x2 + y2 * y2) + z * z;
+    }
+}
+
+void HexagonalPrism::batchBoundary(Point *points, size_t n) const {
+    const double lx = box.x(), ly = std::sqrt(3.0) * box.x(), lz = box.z();
+    const double lx_inv = 1.0 / lx, ly_inv = 1.0 / ly, lz_inv = 1.0 / lz;
+    for (size_t i = 0; i < n; i++) {
+        Point &a = points[i];
+        double x1 = a.x() - lx * anint(a.x() * lx_inv);
+        double y1 = a.y() - ly * anint(a.y() * ly_inv);
+        double x2 = a.x() - 0.5 * lx;
+        double y2 = a.y() - 0.5 * ly;
+        x2 -= lx * anint(x2 * lx_inv);
+        y2 -= ly * anint(y2 * ly_inv);
+        bool first = x1 * x1 + y1 * y1 <= x2 * x2 + y2 * y2;
+        a.x() = first ? x1 : x2;
+        a.y() = first ? y1 : y2;
+        a.z() -= lz * anint(a.z() * lz_inv);
+    }
+}
+
 // =============== Cylinder ===============
 
 Cylinder::Cylinder(double radius, double height) : radius(radius), height(height) {
@@ -440,6 +542,21 @@ void Cylinder::from_json(const json &j) {
 
 void Cylinder::to_json(json &j) const { j = {{"radius", radius}, {"length", height}}; }
 
+void Cylinder::batchSqdist(const Point &a, const Point *points, size_t n, double *result) const {
+    const double height_inv = 1.0 / height;
+    for (size_t i = 0; i < n; i++) {
+        Point distance(a - points[i]);
+        distance.z() -= height * anint(distance.z() * height_inv);
+        result[i] = distance.squaredNorm();
+    }
+}
+
+void Cylinder::batchBoundary(Point *points, size_t n) const {
+    const double height_inv = 1.0 / height;
+    for (size_t i = 0; i < n; i++)
+        points[i].z() -= height * anint(points[i].z() * height_inv);
+}
+
 // =============== Truncated Octahedron ===============
 
 TruncatedOctahedron::TruncatedOctahedron(double side) : side(side) {
@@ -559,6 +676,42 @@ void TruncatedOctahedron::from_json(const json &j) { side = j.at("radius").get<d
 
 void TruncatedOctahedron::to_json(json &j) const { j = {{"radius", side}}; }
 
+/**
+ * The truncated octahedron is the Wigner-Seitz cell of a body centred cubic lattice. After
+ * the cubic minimum image, a single half-cell shift is applied if the point is beyond a
+ * hexagonal face (Allen & Tildesley, Computer Simulation of Liquids, appendix F).
+ */
+void TruncatedOctahedron::batchSqdist(const Point &a, const Point *points, size_t n, double *result) const {
+    const double len = std::sqrt(8.) * side, len_inv = 1.0 / len; // distance between opposite square faces
+    for (size_t i = 0; i < n; i++) {
+        Point distance(a - points[i]);
+        distance.x() -= len * anint(distance.x() * len_inv);
+        distance.y() -= len * anint(distance.y() * len_inv);
+        distance.z() -= len * anint(distance.z() * len_inv);
+        double shift = std::fabs(distance.x()) + std::fabs(distance.y()) + std::fabs(distance.z()) > 0.75 * len
+                           ? 0.5 * len
+                           : 0.0;
+        distance.x() -= std::copysign(shift, distance.x());
+        distance.y() -= std::copysign(shift, distance.y());
+        distance.z() -= std::copysign(shift, distance.z());
+        result[i] = distance.squaredNorm();
+    }
+}
+
+void TruncatedOctahedron::batchBoundary(Point *points, size_t n) const {
+    const double len = std::sqrt(8.) * side, len_inv = 1.0 / len;
+    for (size_t i = 0; i < n; i++) {
+        Point &a = points[i];
+        a.x() -= len * anint(a.x() * len_inv);
+        a.y() -= len * anint(a.y() * len_inv);
+        a.z() -= len * anint(a.z() * len_inv);
+        double shift = std::fabs(a.x()) + std::fabs(a.y()) + std::fabs(a.z()) > 0.75 * len ? 0.5 * len : 0.0;
+        a.x() -= std::copysign(shift, a.x());
+        a.y() -= std::copysign(shift, a.y());
+        a.z() -= std::copysign(shift, a.z());
+    }
+}
+
 // =============== Chameleon==============
 
 const std::map<std::string, Variant> Chameleon::names = {{
@@ -669,5 +822,127 @@ Chameleon &Chameleon::operator=(const Chameleon &geo) {
     return *this;
 }
 
+// =============== CavityGrid ===============
+
+CavityGrid::CavityGrid(double radius, double spacing) : radius(radius), spacing(spacing) {
+    if (radius < 0 or spacing <= 0)
+        throw std::runtime_error("cavity radius must be non-negative and spacing positive");
+}
+
+Point CavityGrid::center(int index) const {
+    Eigen::Vector3i c = {index / (cells.y() * cells.z()), (index / cells.z()) % cells.y(), index % cells.z()};
+    return (c.cast<double>().array() + 0.5).matrix().cwiseProduct(cell) - 0.5 * length;
+}
+
+int CavityGrid::index(const Point &pos) const {
+    Eigen::Vector3i c = ((pos + 0.5 * length).cwiseQuotient(cell)).array().floor().cast<int>();
+    c = c.cwiseMax(0).cwiseMin(cells - Eigen::Vector3i::Ones());
+    return (c.x() * cells.y() + c.y()) * cells.z() + c.z();
+}
+
+/**
+ * Cells within `radius` minus half the cell diagonal from a particle are blocked. For each particle,
+ * only cells in the surrounding bounding box are visited, wherefore the complexity is linear in
+ * the number of particles.
+ */
+void CavityGrid::update(const GeometryBase &geo, const std::vector<Point> &positions) {
+    length = geo.getLength();
+    if (std::fabs(geo.getVolume() - length.prod()) > 1e-6 * length.prod())
+        throw std::runtime_error("cavity grid requires a cuboidal geometry");
+    cells = (length / spacing).array().floor().cast<int>().cwiseMax(1);
+    cell = length.cwiseQuotient(cells.cast<double>());
+    blocked.assign(cells.prod(), false);
+
+    double reduced = radius - 0.5 * cell.norm(); // a cell is blocked if its center is closer than this
+    if (reduced > 0) {
+        Eigen::Vector3i reach = (Point::Constant(reduced).cwiseQuotient(cell)).array().ceil().cast<int>();
+        for (auto &pos : positions) {
+            Eigen::Vector3i c = ((pos + 0.5 * length).cwiseQuotient(cell)).array().floor().cast<int>();
+            Eigen::Vector3i lo, hi; // range of cell indices to visit, possibly outside the box
+            for (int d = 0; d < 3; d++) {
+                bool all = 2 * reach[d] + 1 >= cells[d];
+                lo[d] = all ? 0 : c[d] - reach[d];
+                hi[d] = all ? cells[d] - 1 : c[d] + reach[d];
+            }
+            for (int i = lo.x(); i <= hi.x(); i++)
+                for (int j = lo.y(); j <= hi.y(); j++)
+                    for (int k = lo.z(); k <= hi.z(); k++) {
+                        int n = ((i % cells.x() + cells.x()) % cells.x() * cells.y() +
+                                 (j % cells.y() + cells.y()) % cells.y()) *
+                                    cells.z() +
+                                (k % cells.z() + cells.z()) % cells.z();
+                        if (not blocked[n])
+                            if (geo.sqdist(center(n), pos) < reduced * reduced)
+                                blocked[n] = true;
+                    }
+        }
+    }
+    cavities.clear();
+    for (int n = 0; n < int(blocked.size()); n++)
+        if (not blocked[n])
+            cavities.push_back(n);
+}
+
+double CavityGrid::fraction() const { return blocked.empty() ? 0.0 : double(cavities.size()) / blocked.size(); }
+
+bool CavityGrid::empty() const { return cavities.empty(); }
+
+bool CavityGrid::isCavity(const Point &pos) const { return not blocked.empty() and not blocked[index(pos)]; }
+
+void CavityGrid::randompos(Point &pos, Random &rand) const {
+    assert(not empty());
+    pos = center(*rand.sample(cavities.begin(), cavities.end())) +
+          Point(rand() - 0.5, rand() - 0.5, rand() - 0.5).cwiseProduct(cell);
+}
+
+// =============== CellList ===============
+
+CellList::CellList(double cutoff) : cutoff(cutoff) {
+    if (cutoff <= 0)
+        throw std::runtime_error("cell list cutoff must be positive");
+}
+
+int CellList::index(const Point &pos) const {
+    Eigen::Vector3i c = ((pos.cwiseQuotient(length).array() + 0.5) * cells.cast<double>().array()).floor().cast<int>();
+    c = c.cwiseMax(0).cwiseMin(cells - Eigen::Vector3i::Ones());
+    return (c.x() * cells.y() + c.y()) * cells.z() + c.z();
+}
+
+/**
+ * The stencil of adjacent cells is only rebuilt if the number of cells changes. With fewer than
+ * three cells in a direction, periodic images of a cell coincide and are included only once.
+ */
+void CellList::update(const GeometryBase &geo, const std::vector<Point> &positions) {
+    length = geo.getLength();
+    if (std::fabs(geo.getVolume() - length.prod()) > 1e-6 * length.prod())
+        throw std::runtime_error("cell list requires a cuboidal geometry");
+    Eigen::Vector3i n = (length / cutoff).array().floor().cast<int>().cwiseMax(1);
+    if (n != cells) {
+        cells = n;
+        stencil.assign(cells.prod(), {});
+        Eigen::Vector3i c, d;
+        for (c.x() = 0; c.x() < cells.x(); c.x()++)
+            for (c.y() = 0; c.y() < cells.y(); c.y()++)
+                for (c.z() = 0; c.z() < cells.z(); c.z()++) {
+                    auto &neighbours = stencil[(c.x() * cells.y() + c.y()) * cells.z() + c.z()];
+                    for (int dx = -1; dx <= 1; dx++)
+                        for (int dy = -1; dy <= 1; dy++)
+                            for (int dz = -1; dz <= 1; dz++) {
+                                d = c + Eigen::Vector3i(dx, dy, dz) + cells;
+                                neighbours.push_back(((d.x() % cells.x()) * cells.y() + d.y() % cells.y()) *
+                                                         cells.z() +
+                                                     d.z() % cells.z());
+                            }
+                    std::sort(neighbours.begin(), neighbours.end());
+                    neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+                }
+    }
+    members.resize(stencil.size());
+    for (auto &cell : members)
+        cell.clear();
+    for (size_t j = 0; j < positions.size(); j++)
+        members[index(positions[j])].push_back(int(j));
+}
+
 } // namespace Geometry
 } // namespace Faunus
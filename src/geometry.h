@@ -21,6 +21,8 @@ struct Random;
  * enum type is extended and an initialization within Chameleon::makeGeometry() is provided. In order to make
  * geometry constructable from a json configuration, the map Chameleon::names is extended. When performance is
  * an issue, inlineable implementation of vdist and boundary can be added into respective methods of Chameleon.
+ * Pair loops may instead use Chameleon::dispatch() to be instantiated with a distance policy for the concrete
+ * geometry, see e.g. OrthogonalDistance.
  *
  * All geometry implementation shall be covered by unit tests.
  *
@@ -71,6 +73,19 @@ struct GeometryBase {
         return vdist(a, b).squaredNorm();
     } //!< Squared (minimum) distance between two points
 
+    /**
+     * @brief Squared (minimum) distances from a point to a contiguous array of points
+     * @param a Reference point
+     * @param points Pointer to first of `n` points
+     * @param n Number of points
+     * @param result Output buffer for `n` squared distances
+     *
+     * Geometries override this with branch-free loops that the compiler can vectorise;
+     * the default implementation calls `vdist()` for each point.
+     */
+    virtual void batchSqdist(const Point &a, const Point *points, size_t n, double *result) const;
+    virtual void batchBoundary(Point *points, size_t n) const; //!< Apply boundary conditions to `n` points
+
     virtual ~GeometryBase();
     virtual void to_json(json &j) const = 0;
     virtual void from_json(const json &j) = 0;
@@ -117,6 +132,8 @@ class Cuboid : public GeometryImplementation {
     Point setVolume(double volume, VolumeMethod method = ISOTROPIC) override;
     Point vdist(const Point &a, const Point &b) const override;
     void boundary(Point &a) const override;
+    void batchSqdist(const Point &a, const Point *points, size_t n, double *result) const override;
+    void batchBoundary(Point *points, size_t n) const override;
     bool collision(const Point &a) const override;
     void randompos(Point &m, Random &rand) const override;
     void from_json(const json &j) override;
@@ -161,6 +178,8 @@ class Sphere : public GeometryImplementation {
     Point setVolume(double volume, VolumeMethod method = ISOTROPIC) override;
     Point vdist(const Point &a, const Point &b) const override;
     void boundary(Point &a) const override;
+    void batchSqdist(const Point &a, const Point *points, size_t n, double *result) const override;
+    void batchBoundary(Point *points, size_t n) const override;
     bool collision(const Point &a) const override;
     void randompos(Point &m, Random &rand) const override;
     void from_json(const json &j) override;
@@ -175,6 +194,7 @@ class Sphere : public GeometryImplementation {
 class Hypersphere2d : public Sphere {
   public:
     Point vdist(const Point &a, const Point &b) const override;
+    void batchSqdist(const Point &a, const Point *points, size_t n, double *result) const override;
     bool collision(const Point &a) const override;
     void randompos(Point &m, Random &rand) const override;
     Hypersphere2d(double radius = 0.0);
@@ -197,6 +217,8 @@ class Cylinder : public GeometryImplementation {
     Point setVolume(double volume, VolumeMethod method = ISOTROPIC) override;
     Point vdist(const Point &a, const Point &b) const override;
     void boundary(Point &a) const override;
+    void batchSqdist(const Point &a, const Point *points, size_t n, double *result) const override;
+    void batchBoundary(Point *points, size_t n) const override;
     bool collision(const Point &a) const override;
     void randompos(Point &m, Random &rand) const override;
     void from_json(const json &j) override;
@@ -231,6 +253,8 @@ class HexagonalPrism : public GeometryImplementation {
     Point setVolume(double volume, VolumeMethod method = ISOTROPIC) override;
     Point vdist(const Point &a, const Point &b) const override;
     void boundary(Point &a) const override;
+    void batchSqdist(const Point &a, const Point *points, size_t n, double *result) const override;
+    void batchBoundary(Point *points, size_t n) const override;
     bool collision(const Point &a) const override;
     void randompos(Point &m, Random &rand) const override;
     void from_json(const json &j) override;
@@ -254,6 +278,8 @@ class TruncatedOctahedron : public GeometryImplementation {
     Point setVolume(double volume, VolumeMethod method = ISOTROPIC) override;
     Point vdist(const Point &a, const Point &b) const override;
     void boundary(Point &a) const override;
+    void batchSqdist(const Point &a, const Point *points, size_t n, double *result) const override;
+    void batchBoundary(Point *points, size_t n) const override;
     bool collision(const Point &a) const override;
     void randompos(Point &m, Random &rand) const override;
     void from_json(const json &j) override;
@@ -265,6 +291,46 @@ class TruncatedOctahedron : public GeometryImplementation {
     }; //!< A unique pointer to a copy of self.
 };
 
+/**
+ * @brief Minimum image distance for fixed (non-periodic) boundaries
+ *
+ * This and the following distance policies are selected by `Chameleon::dispatch()` and
+ * used as template arguments for pair loops which then contain no run-time branching
+ * on the geometry type or boundary conditions.
+ */
+struct FixedBoundaryDistance {
+    inline Point vdist(const Point &a, const Point &b) const { return a - b; }
+};
+
+/**
+ * @brief Minimum image distance in an orthogonal box with compile-time periodicity in each direction
+ *
+ * The image shift is evaluated from comparisons rather than branches so that the
+ * kernel can be vectorised. Results are identical to `Cuboid::vdist()`.
+ */
+template <bool X, bool Y, bool Z> struct OrthogonalDistance {
+    Point len, len_half;
+    OrthogonalDistance(const Point &len) : len(len), len_half(0.5 * len) {}
+    inline Point vdist(const Point &a, const Point &b) const {
+        Point distance(a - b);
+        if (X)
+            distance.x() -= len.x() * double((distance.x() > len_half.x()) - (distance.x() < -len_half.x()));
+        if (Y)
+            distance.y() -= len.y() * double((distance.y() > len_half.y()) - (distance.y() < -len_half.y()));
+        if (Z)
+            distance.z() -= len.z() * double((distance.z() > len_half.z()) - (distance.z() < -len_half.z()));
+        return distance;
+    }
+};
+
+/**
+ * @brief Minimum image distance delegated to a concrete geometry without virtual dispatch
+ */
+template <class Tgeometry> struct ImplementationDistance {
+    const Tgeometry &geometry;
+    inline Point vdist(const Point &a, const Point &b) const { return geometry.Tgeometry::vdist(a, b); }
+};
+
 /**
  * @brief Geometry class for spheres, cylinders, cuboids, hexagonal prism, truncated octahedron, slits. It is
  * a wrapper of a concrete geometry implementation.
@@ -301,6 +367,8 @@ class Chameleon : public GeometryBase {
     void setLength(const Point &l);                             //!< Sets the box dimensions.
     void boundary(Point &a) const override;                     //!< Apply boundary conditions
     Point vdist(const Point &a, const Point &b) const override; //!< (Minimum) distance between two points
+    void batchSqdist(const Point &a, const Point *points, size_t n, double *result) const override;
+    void batchBoundary(Point *points, size_t n) const override;
     void randompos(Point &m, Random &rand) const override;
     bool collision(const Point &a) const override;
     void from_json(const json &j) override;
@@ -313,6 +381,15 @@ class Chameleon : public GeometryBase {
 
     static VariantName variantName(const json &j);
 
+    /**
+     * @brief Call a generic function with the minimum image distance policy of the current geometry
+     *
+     * The function, typically a pair loop, is called as `f(distance)` where `distance.vdist(a, b)`
+     * is inlined and specialised for the geometry type and boundary conditions. Geometries without
+     * a specialised policy are passed `*this`.
+     */
+    template <typename Tfunction> auto dispatch(Tfunction &&f) const -> decltype(f(*this));
+
     Chameleon(const Variant type = CUBOID);
     Chameleon(const GeometryImplementation &geo, const Variant type);
 
@@ -354,6 +431,16 @@ inline bool Chameleon::collision(const Point &a) const {
     return geometry->collision(a);
 }
 
+inline void Chameleon::batchSqdist(const Point &a, const Point *points, size_t n, double *result) const {
+    assert(geometry);
+    geometry->batchSqdist(a, points, n, result);
+}
+
+inline void Chameleon::batchBoundary(Point *points, size_t n) const {
+    assert(geometry);
+    geometry->batchBoundary(points, n);
+}
+
 inline void Chameleon::boundary(Point &a) const {
     const auto &boundary_conditions = geometry->boundary_conditions;
     if (boundary_conditions.coordinates == ORTHOGONAL) {
@@ -407,9 +494,95 @@ inline Point Chameleon::vdist(const Point &a, const Point &b) const {
     return distance;
 }
 
+template <typename Tfunction> auto Chameleon::dispatch(Tfunction &&f) const -> decltype(f(*this)) {
+    assert(geometry);
+    const auto &boundary_conditions = geometry->boundary_conditions;
+    const auto &direction = boundary_conditions.direction;
+    switch (boundary_conditions.coordinates) {
+    case ORTHOGONAL:
+        if (direction == BoundaryCondition::BoundaryXYZ(PERIODIC, PERIODIC, PERIODIC))
+            return f(OrthogonalDistance<true, true, true>(len));
+        if (direction == BoundaryCondition::BoundaryXYZ(PERIODIC, PERIODIC, FIXED))
+            return f(OrthogonalDistance<true, true, false>(len));
+        if (direction == BoundaryCondition::BoundaryXYZ(FIXED, FIXED, PERIODIC))
+            return f(OrthogonalDistance<false, false, true>(len));
+        if (direction == BoundaryCondition::BoundaryXYZ(FIXED, FIXED, FIXED))
+            return f(FixedBoundaryDistance());
+        break;
+    case ORTHOHEXAGONAL:
+        if (_type == HEXAGONAL)
+            return f(ImplementationDistance<HexagonalPrism>{static_cast<const HexagonalPrism &>(*geometry)});
+        break;
+    case TRUNC_OCTAHEDRAL:
+        if (_type == OCTAHEDRON)
+            return f(ImplementationDistance<TruncatedOctahedron>{static_cast<const TruncatedOctahedron &>(*geometry)});
+        break;
+    default:
+        break;
+    }
+    return f(*this);
+}
+
 void to_json(json &, const Chameleon &);
 void from_json(const json &, Chameleon &);
 
+/**
+ * @brief Grid of empty cavities used for cavity-biased insertion
+ *
+ * The box is divided into cells of approximately `spacing` side length. A cell is blocked
+ * if every point in it is closer than `radius` to a particle; otherwise it is a cavity.
+ * Drawing positions uniformly from the cavities instead of from the whole volume, `V`, is
+ * exact if insertions closer than `radius` to a particle have infinite energy, _e.g._ due to
+ * a hard core, provided that the Boltzmann factor is weighted by the cavity volume fraction.
+ * Only geometries filling their bounding box, _i.e._ cuboids and slits, are supported.
+ */
+class CavityGrid {
+    Eigen::Vector3i cells = {0, 0, 0}; // number of cells in each direction
+    Point length = {0, 0, 0};          // box side lengths
+    Point cell = {0, 0, 0};            // cell side lengths
+    std::vector<bool> blocked;         // true if cell is not a cavity
+    std::vector<int> cavities;         // index of all cavity cells
+    Point center(int index) const;     // cell center position
+    int index(const Point &pos) const; // index of cell containing position
+
+  public:
+    const double radius;  //!< Minimum distance between cavity and particles
+    const double spacing; //!< Approximate cell side length
+    CavityGrid(double radius, double spacing);
+    void update(const GeometryBase &geo, const std::vector<Point> &positions); //!< Find cavities from scratch
+    double fraction() const;                         //!< Cavity volume fraction
+    bool empty() const;                              //!< True if there are no cavities
+    bool isCavity(const Point &pos) const;           //!< True if position is in a cavity
+    void randompos(Point &pos, Random &rand) const; //!< Uniform random position in cavities
+};
+
+/**
+ * @brief Cell list for finding points within a cutoff distance, _e.g._ mass centers
+ *
+ * The box is divided into cells with side lengths of at least `cutoff` so that all points closer
+ * than `cutoff` to a position are in the same or in adjacent cells, accounting for periodic
+ * boundaries. Candidates are only found from the cells wherefore distances must be checked by
+ * the caller. Only geometries filling their bounding box, _i.e._ cuboids and slits, are supported.
+ */
+class CellList {
+    Eigen::Vector3i cells = {0, 0, 0};     // number of cells in each direction
+    Point length = {0, 0, 0};              // box side lengths
+    std::vector<std::vector<int>> members; // index of points in each cell
+    std::vector<std::vector<int>> stencil; // unique adjacent cells, including itself, of each cell
+    int index(const Point &pos) const;     // index of cell containing position
+
+  public:
+    const double cutoff; //!< Minimum cell side length
+    CellList(double cutoff);
+    void update(const GeometryBase &geo, const std::vector<Point> &positions); //!< Bin positions from scratch
+
+    template <class Function> void forEachCandidate(const Point &pos, Function f) const {
+        for (int cell : stencil[index(pos)])
+            for (int j : members[cell])
+                f(j);
+    } //!< Call `f(j)` for the index, `j`, of all points that may be closer than `cutoff` to `pos`
+};
+
 /*
    void unwrap( Point &a, const Point &ref ) const {
    a = vdist(a, ref) + ref;
@@ -290,18 +290,22 @@ TEST_CASE("[Faunus] Chameleon") {
         }
     };
 
-    //! function compares if Chamelon's and Geometry's vdist methods produce the same result
-    //! using n random points
+    //! function compares if Chamelon's, its dispatched distance policy's, and Geometry's vdist
+    //! methods produce the same result using n random points
     auto compare_vdist = [&slump](Chameleon &chameleon, GeometryImplementation &geo, Cuboid &box, int n = 100) {
-        Point a, b, d_cham, d_geo;
+        Point a, b, d_cham, d_geo, d_dispatch;
         for (int i = 0; i < n; i++) {
             box.randompos(a, slump);
             box.randompos(b, slump);
             d_cham = chameleon.vdist(a, b);
             d_geo = geo.vdist(a, b);
+            d_dispatch = chameleon.dispatch([&](const auto &distance) { return distance.vdist(a, b); });
             CHECK(d_cham.x() == Approx(d_geo.x()));
             CHECK(d_cham.y() == Approx(d_geo.y()));
             CHECK(d_cham.z() == Approx(d_geo.z()));
+            CHECK(d_dispatch.x() == Approx(d_geo.x()));
+            CHECK(d_dispatch.y() == Approx(d_geo.y()));
+            CHECK(d_dispatch.z() == Approx(d_geo.z()));
         }
     };
 
@@ -368,6 +372,51 @@ TEST_CASE("[Faunus] Chameleon") {
     }
 }
 
+TEST_CASE("[Faunus] Batched distances and boundaries") {
+    Random slump;
+    std::vector<Chameleon> geometries = {
+        Chameleon(Cuboid(2.0, 3.0, 4.0), CUBOID),       Chameleon(Slit(2.0, 3.0, 4.0), SLIT),
+        Chameleon(Sphere(5.0), SPHERE),                 Chameleon(Cylinder(2.0, 10.0), CYLINDER),
+        Chameleon(HexagonalPrism(5.0, 20.0), HEXAGONAL), Chameleon(TruncatedOctahedron(5.0), OCTAHEDRON)};
+
+    for (auto &geometry : geometries) {
+        const size_t n = 100;
+        std::vector<Point> points(n);
+        std::vector<double> sqdist(n);
+        Point a;
+        geometry.randompos(a, slump);
+        for (auto &point : points)
+            geometry.randompos(point, slump);
+        geometry.batchSqdist(a, points.data(), n, sqdist.data());
+        for (size_t i = 0; i < n; i++)
+            CHECK(sqdist[i] == Approx(geometry.sqdist(a, points[i])));
+
+        // wrapped points are their own minimum image and keep their distances to other points
+        for (auto &point : points)
+            point += Point(1, 1, 1).cwiseProduct(geometry.getLength()) * (slump() - 0.5);
+        auto wrapped = points;
+        geometry.batchBoundary(wrapped.data(), n);
+        std::vector<double> sqdist_wrapped(n);
+        geometry.batchSqdist(a, points.data(), n, sqdist.data());
+        geometry.batchSqdist(a, wrapped.data(), n, sqdist_wrapped.data());
+        for (size_t i = 0; i < n; i++) {
+            CHECK(sqdist_wrapped[i] == Approx(sqdist[i]));
+            double r2;
+            geometry.batchSqdist(Point(0, 0, 0), &wrapped[i], 1, &r2);
+            CHECK(r2 == Approx(wrapped[i].squaredNorm()));
+        }
+    }
+
+    // zero length, i.e. an unset box, behaves as non-periodic
+    Cuboid empty(0.0);
+    Point a(1, 2, 3), b(-2, 0, 0);
+    double r2;
+    empty.batchSqdist(a, &b, 1, &r2);
+    CHECK(r2 == Approx(13));
+    empty.batchBoundary(&a, 1);
+    CHECK(a == Point(1, 2, 3));
+}
+
 TEST_CASE("[Faunus] anyCenter") {
     Chameleon cyl = json({{"type", "cuboid"}, {"length", 100}, {"radius", 20}});
     std::vector<Particle> p;
@@ -385,6 +434,54 @@ TEST_CASE("[Faunus] anyCenter") {
     CHECK(cm.z() == doctest::Approx(0));
 }
 
+TEST_CASE("[Faunus] CavityGrid") {
+    Cuboid box({10, 10, 10});
+    CavityGrid grid(3.0, 1.0);
+    grid.update(box, {{0, 0, 0}});
+    CHECK(grid.fraction() == Approx(0.968));
+    CHECK(not grid.isCavity({0, 0, 0}));
+    CHECK(grid.isCavity({4.9, 4.9, 4.9}));
+
+    Random random;
+    Point pos;
+    for (int i = 0; i < 100; i++) {
+        grid.randompos(pos, random);
+        CHECK(grid.isCavity(pos));
+    }
+
+    grid.update(box, {{4.9, 0, 0}}); // blocked across the periodic boundary
+    CHECK(not grid.isCavity({-4.9, 0, 0}));
+
+    Sphere sphere(5);
+    CHECK_THROWS(grid.update(sphere, {}));
+}
+
+TEST_CASE("[Faunus] CellList") {
+    Cuboid box({10, 12, 3});
+    Random random;
+    std::vector<Point> positions(200);
+    for (auto &pos : positions)
+        box.randompos(pos, random);
+
+    CellList cells(2.5);
+    cells.update(box, positions);
+    for (auto &a : positions) {
+        size_t found = 0, exact = 0;
+        cells.forEachCandidate(a, [&](int j) {
+            if (box.sqdist(a, positions[j]) < 2.5 * 2.5)
+                found++;
+        });
+        for (auto &b : positions)
+            if (box.sqdist(a, b) < 2.5 * 2.5)
+                exact++;
+        CHECK(found == exact); // each point is visited once, also across periodic boundaries
+    }
+
+    Sphere sphere(5);
+    CHECK_THROWS(cells.update(sphere, {}));
+    CHECK_THROWS(CellList(0));
+}
+
 } // namespace Geometry
 } // namespace Faunus
 
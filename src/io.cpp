@@ -1,9 +1,21 @@
 #include "io.h"
 #include "units.h"
 #include "random.h"
+#include "space.h"
 #include "spdlog/spdlog.h"
 #include <fstream>
 #include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace Faunus {
 
@@ -108,6 +120,20 @@ bool FormatXTC::open(std::string s) {
     return false;
 }
 
+bool FormatXTC::write(const std::string &file, const std::vector<float> &x) {
+    if (not x.empty()) {
+        if (xd == nullptr)
+            xd = xdrfile_open(file.c_str(), "w");
+        if (xd != nullptr) {
+            // rvec is float[3] so the packed buffer can be passed directly
+            auto coordinates = reinterpret_cast<rvec *>(const_cast<float *>(x.data()));
+            write_xtc(xd, x.size() / 3, step_xtc++, time_xtc++, xdbox, coordinates, prec_xtc);
+            return true;
+        }
+    }
+    return false;
+}
+
 void FormatXTC::close() {
     xdrfile_close(xd);
     xd = NULL;
@@ -252,6 +278,81 @@ bool FormatPQR::save(const std::string &file, const FormatPQR::Tpvec &p, Point l
     return IO::writeFile(file, o.str());
 }
 
+XTCWriter::XTCWriter(const std::string &file, int queue) : xtc(1e6), file(file) {
+    if (queue < 1)
+        throw std::runtime_error("xtc queue must be positive");
+    spare.resize(queue);
+    worker = std::thread(&XTCWriter::work, this);
+}
+
+XTCWriter::~XTCWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+        changed.notify_all();
+    }
+    worker.join(); // pending frames are written before the worker exits
+    if (error) {
+        try {
+            std::rethrow_exception(error);
+        } catch (std::exception &e) {
+            faunus_logger->error("xtc writer: {}", e.what());
+        } catch (...) {
+            faunus_logger->error("xtc writer: unknown error");
+        }
+    }
+}
+
+void XTCWriter::work() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        changed.wait(lock, [&] { return stop or not pending.empty(); });
+        if (pending.empty())
+            return;
+        Frame frame = std::move(pending.front());
+        pending.pop_front();
+        busy = true;
+        lock.unlock();
+        std::exception_ptr exception = nullptr;
+        try {
+            xtc.setbox(frame.box);
+            if (not xtc.write(file, frame.x))
+                faunus_logger->warn("error saving xtc");
+        } catch (...) {
+            exception = std::current_exception();
+        }
+        lock.lock();
+        if (exception and not error)
+            error = exception;
+        spare.push_back(std::move(frame));
+        busy = false;
+        changed.notify_all();
+    }
+}
+
+XTCWriter::Frame XTCWriter::acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&] { return not spare.empty(); }); // back-pressure
+    if (error)
+        std::rethrow_exception(std::exchange(error, nullptr));
+    Frame frame = std::move(spare.back());
+    spare.pop_back();
+    return frame;
+}
+
+void XTCWriter::submit(Frame &&frame) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back(std::move(frame));
+    changed.notify_all();
+}
+
+void XTCWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&] { return pending.empty() and not busy; });
+    if (error)
+        std::rethrow_exception(std::exchange(error, nullptr));
+}
+
 bool FormatXYZ::save(const std::string &file, const FormatXYZ::Tpvec &p, const Point &box) {
     std::ostringstream o;
     o << p.size() << "\n" << box.transpose() << "\n";
@@ -287,6 +388,241 @@ bool FormatXYZ::load(const std::string &file, FormatXYZ::Tpvec &p, bool append)
     return false;
 }
 
+namespace {
+const char checkpoint_magic[8] = {'F', 'A', 'U', 'N', 'C', 'K', 'P', 'T'};
+const uint32_t checkpoint_endian = 0x01020304;
+const size_t checkpoint_chunk = 4096; // particles per write buffer
+
+inline size_t padded(size_t bytes) { return (bytes + 7) & ~size_t(7); } // round up to 8-byte boundary
+
+/**
+ * Read-only view of a complete file. The file is memory mapped if
+ * supported by the platform; otherwise it is read into a buffer.
+ */
+class MappedFile {
+    const char *ptr = nullptr;
+    size_t len = 0;
+    bool mapped = false;
+    std::vector<char> buffer;
+
+  public:
+    explicit MappedFile(const std::string &file) {
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(file.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            struct stat st;
+            if (::fstat(fd, &st) == 0 and st.st_size > 0) {
+                void *addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr != MAP_FAILED) {
+                    ::madvise(addr, st.st_size, MADV_SEQUENTIAL);
+                    ptr = static_cast<const char *>(addr);
+                    len = st.st_size;
+                    mapped = true;
+                }
+            }
+            ::close(fd);
+        }
+#endif
+        if (not mapped) {
+            std::ifstream f(file, std::ios::binary);
+            if (not f)
+                throw std::runtime_error("cannot open " + file);
+            buffer.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+            ptr = buffer.data();
+            len = buffer.size();
+        }
+    }
+
+    ~MappedFile() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (mapped)
+            ::munmap(const_cast<char *>(ptr), len);
+#endif
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data(size_t offset, size_t bytes) const {
+        if (offset + bytes > len)
+            throw std::runtime_error("unexpected end of file");
+        return ptr + offset;
+    }
+};
+
+/**
+ * Flush a file, or directory, to the storage device. Without this, a crash shortly
+ * after renaming a checkpoint may leave an empty or missing file, depending on the
+ * file system. Does nothing on platforms without `fsync`.
+ */
+void syncToDisk(const std::string &path) {
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("cannot open " + path);
+    int error = ::fsync(fd);
+    ::close(fd);
+    if (error != 0)
+        throw std::runtime_error("cannot sync " + path);
+#endif
+}
+} // namespace
+
+void FormatCheckpoint::save(const std::string &file, const Space &spc, const json &meta) {
+    json j = meta;
+    j["geometry"] = spc.geo;
+    json extensions = json::array(); // sparse list of [index, particle] for extended particles
+    for (size_t i = 0; i < spc.p.size(); i++)
+        if (spc.p[i].hasExtension())
+            extensions.push_back({i, spc.p[i]});
+    if (not extensions.empty())
+        j["extensions"] = extensions;
+    auto metadata = json::to_ubjson(j);
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, checkpoint_magic, sizeof(header.magic));
+    header.version = version;
+    header.endian = checkpoint_endian;
+    header.particles = spc.p.size();
+    header.groups = spc.groups.size();
+    header.metasize = metadata.size();
+
+    std::string tmpfile = file + ".tmp";
+    std::ofstream f(tmpfile, std::ios::binary | std::ios::trunc);
+    if (not f)
+        throw std::runtime_error("cannot write checkpoint " + tmpfile);
+
+    const char zeros[8] = {0};
+    auto write = [&f](const void *data, size_t bytes) { f.write(static_cast<const char *>(data), bytes); };
+
+    write(&header, sizeof(header));
+    write(metadata.data(), metadata.size());
+    write(zeros, padded(metadata.size()) - metadata.size());
+
+    const size_t n = spc.p.size();
+    std::vector<double> real;
+    std::vector<int32_t> integer;
+    real.reserve(3 * checkpoint_chunk);
+    integer.reserve(checkpoint_chunk);
+    for (size_t first = 0; first < n; first += checkpoint_chunk) { // positions
+        real.clear();
+        for (size_t i = first; i < std::min(n, first + checkpoint_chunk); i++)
+            real.insert(real.end(), {spc.p[i].pos.x(), spc.p[i].pos.y(), spc.p[i].pos.z()});
+        write(real.data(), real.size() * sizeof(double));
+    }
+    for (size_t first = 0; first < n; first += checkpoint_chunk) { // charges
+        real.clear();
+        for (size_t i = first; i < std::min(n, first + checkpoint_chunk); i++)
+            real.push_back(spc.p[i].charge);
+        write(real.data(), real.size() * sizeof(double));
+    }
+    for (size_t first = 0; first < n; first += checkpoint_chunk) { // ids
+        integer.clear();
+        for (size_t i = first; i < std::min(n, first + checkpoint_chunk); i++)
+            integer.push_back(spc.p[i].id);
+        write(integer.data(), integer.size() * sizeof(int32_t));
+    }
+    write(zeros, padded(n * sizeof(int32_t)) - n * sizeof(int32_t));
+
+    for (auto &g : spc.groups) {
+        GroupRecord record;
+        std::memset(&record, 0, sizeof(record));
+        Space::Tpvec::const_iterator begin = g.begin();
+        record.begin = std::distance(spc.p.begin(), begin);
+        record.size = g.size();
+        record.capacity = g.capacity();
+        std::copy(g.cm.data(), g.cm.data() + 3, record.cm);
+        record.id = g.id;
+        record.confid = g.confid;
+        record.atomic = g.atomic;
+        record.compressible = g.compressible;
+        write(&record, sizeof(record));
+    }
+
+    f.close();
+    if (not f)
+        throw std::runtime_error("error writing checkpoint " + tmpfile);
+    syncToDisk(tmpfile); // content must be on disk before it replaces the old checkpoint
+    if (std::rename(tmpfile.c_str(), file.c_str()) != 0) // atomic replacement of any existing checkpoint
+        throw std::runtime_error("cannot rename " + tmpfile + " to " + file);
+    auto slash = file.find_last_of('/');
+    syncToDisk((slash == std::string::npos) ? "." : file.substr(0, slash + 1)); // make the rename durable
+}
+
+json FormatCheckpoint::load(const std::string &file, Space &spc) {
+    using namespace std::string_literals;
+    try {
+        MappedFile map(file);
+        Header header;
+        std::memcpy(&header, map.data(0, sizeof(header)), sizeof(header));
+        if (std::memcmp(header.magic, checkpoint_magic, sizeof(header.magic)) != 0)
+            throw std::runtime_error("not a checkpoint file");
+        if (header.endian != checkpoint_endian)
+            throw std::runtime_error("byte order mismatch");
+        if (header.version != version)
+            throw std::runtime_error("unsupported version " + std::to_string(header.version));
+
+        size_t offset = sizeof(header);
+        auto meta = reinterpret_cast<const uint8_t *>(map.data(offset, header.metasize));
+        json j = json::from_ubjson(std::vector<uint8_t>(meta, meta + header.metasize));
+        offset += padded(header.metasize);
+
+        const size_t n = header.particles;
+        const char *positions = map.data(offset, 3 * n * sizeof(double));
+        offset += 3 * n * sizeof(double);
+        const char *charges = map.data(offset, n * sizeof(double));
+        offset += n * sizeof(double);
+        const char *ids = map.data(offset, n * sizeof(int32_t));
+        offset += padded(n * sizeof(int32_t));
+        const char *groups = map.data(offset, header.groups * sizeof(GroupRecord));
+
+        spc.clear();
+        spc.geo = j.at("geometry");
+        spc.p.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            int32_t id;
+            std::memcpy(spc.p[i].pos.data(), positions + 3 * i * sizeof(double), 3 * sizeof(double));
+            std::memcpy(&spc.p[i].charge, charges + i * sizeof(double), sizeof(double));
+            std::memcpy(&id, ids + i * sizeof(int32_t), sizeof(int32_t));
+            spc.p[i].id = id;
+        }
+        if (j.count("extensions") > 0) {
+            for (auto &i : j["extensions"])
+                spc.p.at(i.at(0).get<size_t>()) = i.at(1).get<Particle>();
+            j.erase("extensions");
+        }
+
+        spc.groups.reserve(header.groups);
+        size_t begin_expected = 0; // groups must tile the particle vector without gaps or overlaps
+        for (size_t k = 0; k < header.groups; k++) {
+            GroupRecord record;
+            std::memcpy(&record, groups + k * sizeof(GroupRecord), sizeof(record));
+            if (record.begin != begin_expected or record.size > record.capacity or record.capacity > n - record.begin)
+                throw std::runtime_error("group out of range");
+            begin_expected = record.begin + record.capacity;
+            auto begin = spc.p.begin() + record.begin;
+            Space::Tgroup g(begin, begin + record.size);
+            g.trueend() = begin + record.capacity;
+            g.id = record.id;
+            g.confid = record.confid;
+            g.cm = Point(record.cm[0], record.cm[1], record.cm[2]);
+            g.atomic = record.atomic;
+            g.compressible = record.compressible;
+            if (not g.empty() and not g.atomic)
+                if (spc.geo.sqdist(g.cm, Geometry::massCenter(g.begin(), g.end(), spc.geo.getBoundaryFunc(), -g.cm)) >
+                    1e-6)
+                    throw std::runtime_error("mass center mismatch");
+            spc.groups.push_back(g);
+        }
+        if (begin_expected != n)
+            throw std::runtime_error("groups do not cover all particles");
+        return j;
+    } catch (std::exception &e) {
+        throw std::runtime_error("checkpoint '"s + file + "': " + e.what());
+    }
+}
+
 std::string FormatMXYZ::p2s(const Particle &, int) {
     std::ostringstream o;
     o.precision(5);
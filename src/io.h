@@ -3,9 +3,15 @@
 #include "core.h"
 #include "particle.h"
 #include <range/v3/distance.hpp>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 
 namespace Faunus {
 
+struct Space;
+
 #ifndef __cplusplus
 #define __cplusplus
 #endif
@@ -229,6 +235,69 @@ class FormatGRO {
     }
 };
 
+/**
+ * @brief Binary checkpoint of a simulation space
+ *
+ * Native restart format for large systems. The file starts with a fixed
+ * size, versioned header followed by a small UBJSON metadata block (geometry,
+ * random number generator states, reactions and any extended particle
+ * properties) and then raw, 8-byte aligned arrays:
+ *
+ * Section      | Type                | Count
+ * ------------ | ------------------- | ----------------
+ * `Header`     | see below           | 1
+ * metadata     | UBJSON              | `metasize` bytes
+ * positions    | double              | 3N
+ * charges      | double              | N
+ * ids          | int32               | N
+ * groups       | `GroupRecord`       | number of groups
+ *
+ * Files are written to a temporary file which is then renamed so that an
+ * existing checkpoint is never left half written, making it safe to save
+ * frequently during long runs. On POSIX systems loading uses `mmap`
+ * whereby the arrays are copied directly from the page cache.
+ */
+struct FormatCheckpoint {
+    static constexpr uint32_t version = 1;
+
+    struct Header {
+        char magic[8];      //!< "FAUNCKPT"
+        uint32_t version;   //!< file format version
+        uint32_t endian;    //!< 0x01020304 written in native byte order
+        uint64_t particles; //!< number of particles incl. inactive ones
+        uint64_t groups;    //!< number of groups
+        uint64_t metasize;  //!< size of UBJSON metadata in bytes
+    };
+
+    struct GroupRecord {
+        uint64_t begin;     //!< index of first particle
+        uint64_t size;      //!< number of active particles
+        uint64_t capacity;  //!< number of active and inactive particles
+        double cm[3];       //!< mass center
+        int32_t id;         //!< molecule id
+        int32_t confid;     //!< conformation id
+        uint8_t atomic;
+        uint8_t compressible;
+        uint8_t padding[6];
+    };
+
+    /**
+     * @brief Save space to binary checkpoint
+     * @param file Filename
+     * @param spc Space to save
+     * @param meta Additional data to store, for example random number generator states
+     */
+    static void save(const std::string &file, const Space &spc, const json &meta = json::object());
+
+    /**
+     * @brief Load space from binary checkpoint
+     * @param file Filename
+     * @param spc Destination space; existing particles and groups are replaced
+     * @return Metadata stored in the file (including the `meta` passed to `save()`)
+     */
+    static json load(const std::string &file, Space &spc);
+};
+
 /**
  * @brief GROMACS xtc compressed trajectory file format
  *
@@ -247,6 +316,7 @@ class FormatXTC {
     rvec *x_xtc;           //!< vector of particle coordinates
     float time_xtc, prec_xtc = 1000;
     int natoms_xtc, step_xtc;
+    std::vector<float> buffer; //!< packed coordinates reused between frames
 
   public:
     int getNumAtoms();
@@ -276,9 +346,9 @@ class FormatXTC {
                     // Geometry::Chameleon *geo = dynamic_cast<Geometry::Chameleon *>(&c.geo);
                     // if (geo == nullptr or geo->type not_eq Geometry::CUBOID)
                     //    throw std::runtime_error("Cuboid-like geometry required");
-                    Point len_half = 0.5 * c.geo.getLength();
                     if (setbox)
                         c.geo.setLength(Point(10.0 * xdbox[0][0], 10.0 * xdbox[1][1], 10.0 * xdbox[2][2]));
+                    Point len_half = 0.5 * c.geo.getLength(); // origin is shifted by half the frame's box
                     for (size_t i = 0; i < c.p.size(); i++) {
                         c.p[i].pos.x() = 10.0 * x_xtc[i][0];
                         c.p[i].pos.y() = 10.0 * x_xtc[i][1];
@@ -308,26 +378,35 @@ class FormatXTC {
      */
     template <class Titer1, class Titer2 /** particle vector iterator */>
     bool save(const std::string &file, Titer1 begin, Titer2 end) {
-        if (begin != end) {
-            if (xd == nullptr)
-                xd = xdrfile_open(&file[0], "w");
-            if (xd != nullptr) {
-                rvec *x = new rvec[ranges::distance(begin, end)];
-                size_t N = 0;
-                for (auto j = begin; j != end; ++j) {
-                    x[N][0] = j->pos.x() * 0.1 + xdbox[0][0] * 0.5; // AA->nm
-                    x[N][1] = j->pos.y() * 0.1 + xdbox[1][1] * 0.5; // move inside sim. box
-                    x[N][2] = j->pos.z() * 0.1 + xdbox[2][2] * 0.5; //
-                    N++;
-                }
-                write_xtc(xd, N, step_xtc++, time_xtc++, xdbox, x, prec_xtc);
-                delete[] x;
-                return true;
-            }
+        buffer.clear();
+        pack(begin, end, Point(10 * xdbox[0][0], 10 * xdbox[1][1], 10 * xdbox[2][2]), buffer);
+        return write(file, buffer);
+    }
+
+    /**
+     * @brief Append particle positions to a packed xtc coordinate buffer
+     * @param begin First particle
+     * @param end End of particles
+     * @param box Box dimensions (angstrom) used to move the origin to the box corner
+     * @param x Destination buffer with three floats per particle (nanometers)
+     */
+    template <class Titer1, class Titer2>
+    static void pack(Titer1 begin, Titer2 end, const Point &box, std::vector<float> &x) {
+        const float len[3] = {float(0.1 * box.x()), float(0.1 * box.y()), float(0.1 * box.z())}; // AA->nm
+        x.reserve(x.size() + 3 * ranges::distance(begin, end));
+        for (auto j = begin; j != end; ++j) {
+            x.push_back(j->pos.x() * 0.1 + len[0] * 0.5); // AA->nm
+            x.push_back(j->pos.y() * 0.1 + len[1] * 0.5); // move inside sim. box
+            x.push_back(j->pos.z() * 0.1 + len[2] * 0.5); //
         }
-        return false;
     }
 
+    /**
+     * Write packed coordinates (see `pack()`) as a new frame using the
+     * current box dimensions. The file is opened for writing if needed.
+     */
+    bool write(const std::string &file, const std::vector<float> &x);
+
     /**
      * This will open an xtc file for reading. The number of atoms in each frame
      * is saved and memory for the coordinate array is allocated.
@@ -343,6 +422,57 @@ class FormatXTC {
     void setbox(const Point &p);
 };
 
+/**
+ * @brief Background xtc trajectory writer
+ *
+ * Frames are packed into recycled coordinate buffers by the calling thread
+ * while compression and disk I/O take place in a worker thread. At most
+ * `queue` frames are in flight; if the worker falls behind, `push()`
+ * blocks until a buffer is returned. Remaining frames are written when
+ * the object is destroyed and errors not yet reported by `push()` or
+ * `flush()` are then logged.
+ */
+class XTCWriter {
+    struct Frame {
+        Point box;            // box dimensions (angstrom)
+        std::vector<float> x; // packed coordinates, see FormatXTC::pack()
+    };
+    FormatXTC xtc;
+    std::string file;
+    std::deque<Frame> pending; // frames waiting to be written
+    std::vector<Frame> spare;  // recycled buffers
+    std::mutex mutex;
+    std::condition_variable changed; // signalled whenever `pending` or `spare` changes
+    bool busy = false, stop = false;
+    std::exception_ptr error = nullptr; // first exception thrown by the worker
+    std::thread worker;
+
+    void work();
+    Frame acquire();            //!< Wait for a spare buffer
+    void submit(Frame &&frame); //!< Queue frame for writing
+
+  public:
+    XTCWriter(const std::string &file, int queue);
+    ~XTCWriter();
+
+    /**
+     * @brief Queue a frame
+     * @param box Box dimensions (angstrom)
+     * @param fill Function `void(std::vector<float>&)` that appends packed coordinates
+     *
+     * Exceptions from previous writes are rethrown here.
+     */
+    template <class Tfunc> void push(const Point &box, Tfunc fill) {
+        Frame frame = acquire();
+        frame.box = box;
+        frame.x.clear();
+        fill(frame.x);
+        submit(std::move(frame));
+    }
+
+    void flush(); //!< Wait until all queued frames are written; rethrows, once, any error from the worker
+};
+
 /**
  * @brief Convert FASTA sequence to atom id sequence
  * @param fasta FASTA sequence, capital letters.
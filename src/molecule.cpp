@@ -502,6 +502,14 @@ void to_json(json &j, const ExclusionsVicinity &exclusions) {
 void from_json(const json &j, MoleculeInserter &inserter) { inserter.from_json(j); }
 void to_json(json &j, const MoleculeInserter &inserter) { inserter.to_json(j); }
 
+std::shared_ptr<Geometry::CavityGrid> RandomInserter::makeCavities(const json &j) {
+    double radius = j.at("radius").get<double>();
+    for (auto &a : atoms)
+        if (not a.implicit and a.sigma > 0 and radius > a.sigma)
+            throw std::runtime_error("cavity radius exceeds hard-sphere contact distance of " + a.name);
+    return std::make_shared<Geometry::CavityGrid>(radius, j.value("spacing", 1.0));
+}
+
 ParticleVector RandomInserter::operator()(Geometry::GeometryBase &geo, const ParticleVector &, MoleculeData &mol) {
     int cnt = 0;
     QuaternionRotate rot;
@@ -510,6 +518,22 @@ ParticleVector RandomInserter::operator()(Geometry::GeometryBase &geo, const Par
     if (std::fabs(geo.getVolume()) < 1e-20)
         throw std::runtime_error("geometry has zero volume");
 
+    lnbias = 0;
+    if (cavities) {
+        if (keep_positions or dir != Point(1, 1, 1) or offset != Point(0, 0, 0))
+            throw std::runtime_error("cavity-biased insertion requires unrestricted random positions");
+        if (cavities->empty()) { // no space left; the Boltzmann factor is zero
+            lnbias = -pc::infty;
+            return ParticleVector();
+        }
+    }
+    auto randompos = [&](Point &pos) {
+        if (cavities)
+            cavities->randompos(pos, random);
+        else
+            geo.randompos(pos, random);
+    };
+
     ParticleVector v = mol.conformations.get(); // get random, weighted conformation
     conformation_ndx = mol.conformations.index; // lastest index
 
@@ -523,7 +547,7 @@ ParticleVector RandomInserter::operator()(Geometry::GeometryBase &geo, const Par
                     rot.set(2 * pc::pi * random(), ranunit(random));
                     i.rotate(rot.first, rot.second);
                 }
-                geo.randompos(i.pos, random);
+                randompos(i.pos);
                 i.pos = i.pos.cwiseProduct(dir) + offset;
                 geo.boundary(i.pos);
             }
@@ -534,7 +558,7 @@ ParticleVector RandomInserter::operator()(Geometry::GeometryBase &geo, const Par
                         throw std::runtime_error("Error: Inserted molecule does not fit in container");
             } else {
                 Point cm;                                        // new mass center position
-                geo.randompos(cm, random);                       // random point in container
+                randompos(cm);                                   // random point in container
                 cm = cm.cwiseProduct(dir);                       // apply user defined directions (default: 1,1,1)
                 Geometry::cm2origo(v.begin(), v.end());          // translate to origin
                 rot.set(random() * 2 * pc::pi, ranunit(random)); // random rot around random vector
@@ -563,6 +587,8 @@ ParticleVector RandomInserter::operator()(Geometry::GeometryBase &geo, const Par
             }
         }
     } while (containerOverlap);
+    if (cavities) // each atom of atomic molecules is placed independently
+        lnbias = (mol.atomic ? v.size() : 1) * std::log(cavities->fraction());
     return v;
 }
 
@@ -15,6 +15,7 @@ struct BondData;
 
 namespace Geometry {
 struct GeometryBase;
+class CavityGrid;
 }
 
 class MoleculeData;
@@ -48,10 +49,21 @@ struct RandomInserter : public MoleculeInserter {
     bool allow_overlap = false;   //!< Set to true to skip container overlap check
     int max_trials = 20'000;      //!< Maximum number of container overlap checks
     int conformation_ndx = -1;    //!< Index of last used conformation
+    std::shared_ptr<Geometry::CavityGrid> cavities = nullptr; //!< If set, positions are drawn from cavities only
+    double lnbias = 0; //!< ln of cavity volume fraction(s) of last insertion; add to -u for unbiased averages
 
     ParticleVector operator()(Geometry::GeometryBase &geo, const ParticleVector &, MoleculeData &mol) override;
     void from_json(const json &j) override;
     void to_json(json &j) const override;
+
+    /**
+     * @brief Create cavity grid from json object with `radius` and `spacing`
+     * @throw if `radius` exceeds the hard-sphere contact distance, sigma, of any atom type
+     *
+     * The bias is exact only if insertions closer than `radius` to a particle have infinite energy. A larger radius
+     * would silently drop the non-zero Boltzmann weight of the excluded region.
+     */
+    static std::shared_ptr<Geometry::CavityGrid> makeCavities(const json &j);
 };
 
 /**
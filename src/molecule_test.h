@@ -1,4 +1,5 @@
 #include "molecule.h"
+#include "geometry.h"
 
 namespace Faunus {
 
@@ -207,6 +208,15 @@ TEST_CASE("[Faunus] Conformation") {
     CHECK(p[0].charge == 0.5);
 }
 
+TEST_CASE("[Faunus] RandomInserter::makeCavities") {
+    atoms = R"([{ "A": { "sigma": 2.0 } }, { "B": { "sigma": 4.0 } }, { "H": { "implicit": true } }])"_json
+                .get<decltype(atoms)>();
+    auto cavities = RandomInserter::makeCavities({{"radius", 2.0}, {"spacing", 0.5}});
+    CHECK(cavities->radius == Approx(2.0));
+    CHECK(cavities->spacing == Approx(0.5));
+    CHECK_THROWS(RandomInserter::makeCavities({{"radius", 2.1}})); // beyond contact of A
+}
+
 TEST_CASE("[Faunus] ReactionData") {
     using doctest::Approx;
 
@@ -1,5 +1,6 @@
 #include "montecarlo.h"
 #include "speciation.h"
+#include "io.h"
 #include "spdlog/spdlog.h"
 
 namespace Faunus {
@@ -25,6 +26,7 @@ void MCSimulation::init() {
     state1.pot.init();
     double u1 = state1.pot.energy(c);
     uinit = u1;
+    state1.pot.ledger.reset(state1.pot.term_energies); // running energy of accepted states
 
     state2.sync(state1, c); // copy all information from state1 into state2
     state2.pot.init();
@@ -43,43 +45,105 @@ void MCSimulation::init() {
     for (auto speciation_move : moves.moves().find<Move::SpeciationMove>()) {
         speciation_move->setOther(state1.spc);
     }
+
+#ifdef ENABLE_MPI
+    // label exchange moves swap Hamiltonians rather than configurations
+    for (auto temper : moves.moves().find<Move::ParallelTempering>()) {
+        temper->relabel = [&](const json &j) { relabel(j); };
+    }
+#endif
 }
 
+/**
+ * The energy difference between the new and old Hamiltonian is added to the
+ * running energy sum so that the drift remains meaningful.
+ */
+void MCSimulation::relabel(const json &j) {
+    Change c;
+    c.all = true;
+    double uold = state1.pot.energy(c);
+    pc::temperature = j.at("temperature").get<double>() * 1.0_K;
+    state1.pot.reset(state1.spc, j.at("energy"));
+    state2.pot.reset(state2.spc, j.at("energy"));
+    state1.pot.init();
+    state2.pot.init();
+    dusum += state1.pot.energy(c) - uold;
+    state1.pot.ledger.reset(state1.pot.term_energies);
+}
+
+/**
+ * If the system is decomposed over MPI ranks, this is collective and returns the
+ * largest absolute drift of all ranks.
+ */
 double MCSimulation::drift() {
     Change c;
     c.all = true;
     double ufinal = state1.pot.energy(c);
     double du = ufinal - uinit;
+    double drift = std::numeric_limits<double>::quiet_NaN();
     if (std::isfinite(du)) {
         if (std::fabs(du) < 1e-10)
-            return 0;
-        if (uinit != 0)
-            return (ufinal - (uinit + dusum)) / uinit;
+            drift = 0;
+        else if (uinit != 0)
+            drift = (ufinal - (uinit + dusum)) / uinit;
         else if (ufinal != 0)
-            return (ufinal - (uinit + dusum)) / ufinal;
+            drift = (ufinal - (uinit + dusum)) / ufinal;
     }
-    return std::numeric_limits<double>::quiet_NaN();
+#ifdef ENABLE_MPI
+    for (auto domains : moves.moves().find<Move::DomainTranslate>())
+        drift = domains->drift(drift);
+#endif
+    return drift;
+}
+
+int MCSimulation::label() const {
+#ifdef ENABLE_MPI
+    for (auto temper : moves.moves().find<Move::ParallelTempering>())
+        return temper->currentLabel();
+#endif
+    return -1;
 }
 
 MCSimulation::MCSimulation(const json &j, MPI::MPIController &mpi) : state1(j), state2(j), moves(j, state2.spc, mpi) {
     init();
+#ifdef ENABLE_MPI
+    for (auto domains : moves.moves().find<Move::DomainTranslate>())
+        domains->checkRange(state1.pot);
+#endif
 }
 
 void MCSimulation::restore(const json &j) {
     try {
         state1.spc = j; // old/accepted state
         state2.spc = j; // trial state
-        if (j.count("random-move") == 1)
-            Move::Movebase::slump = j["random-move"]; // restore move random number generator
-        if (j.count("random-global") == 1)
-            Faunus::random = j["random-global"];                     // restore global random number generator
-        reactions = j.at("reactionlist").get<decltype(reactions)>(); // should be handled by space
+        restoreGlobals(j);
+        init();
+    } catch (std::exception &e) {
+        throw std::runtime_error("error initialising simulation: "s + e.what());
+    }
+}
+
+void MCSimulation::restore(const std::string &checkpoint) {
+    try {
+        json j = FormatCheckpoint::load(checkpoint, state1.spc); // old/accepted state
+        Change c;
+        c.all = true;
+        state2.spc.sync(state1.spc, c); // trial state
+        restoreGlobals(j);
         init();
     } catch (std::exception &e) {
         throw std::runtime_error("error initialising simulation: "s + e.what());
     }
 }
 
+void MCSimulation::restoreGlobals(const json &j) {
+    if (j.count("random-move") == 1)
+        Move::Movebase::slump = j["random-move"]; // restore move random number generator
+    if (j.count("random-global") == 1)
+        Faunus::random = j["random-global"];                     // restore global random number generator
+    reactions = j.at("reactionlist").get<decltype(reactions)>(); // should be handled by space
+}
+
 void MCSimulation::move() {
     Change change;
     for (int i = 0; i < moves.repeat(); i++) {
@@ -119,10 +183,15 @@ void MCSimulation::move() {
 
                 double bias = (**mv).bias(change, uold, unew);
                 double ideal = IdealTerm(state2.spc, state1.spc, change);
-                if (std::isnan(du + bias))
+
+                // an infinite bias enforces acceptance or rejection regardless of the energy,
+                // which may itself be infinite, i.e. for halo updates in `DomainTranslate`
+                double total = std::isinf(bias) ? bias : du + bias + ideal;
+                if (std::isnan(total))
                     faunus_logger->error("Infinite du + bias in "+lastMoveName+" move.");
 
-                if (metropolis(du + bias + ideal)) { // accept move
+                if (metropolis(total)) { // accept move
+                    state1.pot.ledger.accept(state2.pot.term_energies, state1.pot.term_energies);
                     state1.sync(state2, change);
                     (**mv).accept(change);
                 } else { // reject move
@@ -131,11 +200,67 @@ void MCSimulation::move() {
                     du = 0;
                 }
                 dusum += du; // sum of all energy changes
-            } else state2.sync(state1, change);
+                moves.update(mv, du);
+            } else {
+                state2.sync(state1, change);
+                moves.update(mv, 0);
+            }
         }
     }
 }
 
+/**
+ * Configurations are swapped by deep copies of the spaces and the exchange is accepted
+ * according to the energy change of the extended ensemble,
+ * \f$ \Delta U = u_a(x_b) - u_a(x_a) + u_b(x_a) - u_b(x_b) \f$.
+ * The Hamiltonians are left untouched, but re-initialized, and the two replicas
+ * must be run from the same thread (or be otherwise idle). Each replica is evaluated
+ * in its own context which is updated afterwards, while that of the calling thread is restored.
+ *
+ * @returns True if the exchange was accepted
+ */
+bool MCSimulation::exchange(MCSimulation &other, Random &random, Context &context, Context &other_context) {
+    if (state1.spc.p.size() != other.state1.spc.p.size())
+        throw std::runtime_error("replica exchange requires equal number of particles");
+    const Context caller = Context::current();
+    Change c;
+    c.all = true;
+    auto within = [](Context &replica, std::function<void()> f) { // run `f` in the context of a replica
+        replica.activate();
+        f();
+        replica = Context::current();
+    };
+    auto swapConfigurations = [&]() {
+        Space tmp;
+        tmp.sync(state1.spc, c);
+        state1.spc.sync(other.state1.spc, c);
+        other.state1.spc.sync(tmp, c);
+        for (auto sim : {std::make_pair(this, &context), std::make_pair(&other, &other_context)})
+            within(*sim.second, [&]() {
+                sim.first->state2.spc.sync(sim.first->state1.spc, c);
+                sim.first->state1.pot.init();
+                sim.first->state2.pot.init();
+            });
+    };
+    double uold = 0, uold_other = 0, unew = 0, unew_other = 0;
+    within(context, [&]() { uold = state1.pot.energy(c); });
+    within(other_context, [&]() { uold_other = other.state1.pot.energy(c); });
+    swapConfigurations();
+    within(context, [&]() { unew = state1.pot.energy(c); });
+    within(other_context, [&]() { unew_other = other.state1.pot.energy(c); });
+    double du = (unew - uold) + (unew_other - uold_other);
+    bool accepted = not(std::isnan(du) or random() > std::exp(-du));
+    if (accepted) {
+        dusum += unew - uold;
+        other.dusum += unew_other - uold_other;
+        for (auto sim : {this, &other}) // terms still hold the energies of the swapped configurations
+            sim->state1.pot.ledger.reset(sim->state1.pot.term_energies);
+    } else
+        swapConfigurations(); // reject: swap back
+    caller.activate();
+    return accepted;
+}
+
 void MCSimulation::to_json(json &j) {
     j = state1.spc.info();
     j["temperature"] = pc::temperature / 1.0_K;
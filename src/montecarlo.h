@@ -4,6 +4,7 @@
 
 #include "energy.h"
 #include "move.h"
+#include "context.h"
 
 namespace Faunus {
 class MCSimulation {
@@ -28,6 +29,8 @@ class MCSimulation {
     Average<double> uavg;
 
     void init();
+    void relabel(const json &j); //!< Replace temperature and Hamiltonian (label exchange)
+    void restoreGlobals(const json &j); //!< Restore random number generators and reactions from state
 
   public:
     Move::Propagator moves;
@@ -41,6 +44,7 @@ class MCSimulation {
 
     MCSimulation(const json &j, MPI::MPIController &mpi);
     double drift(); //!< Calculates the relative energy drift from initial configuration
+    int label() const; //!< Label of the current thermodynamic state; -1 if labels are not exchanged
 
     /* currently unused -- see Analysis::SaveState.
                     void store(json &j) const {
@@ -50,12 +54,67 @@ class MCSimulation {
                     } // store system to json object
     */
     void restore(const json &j); //!< restore system from previously store json object
+    void restore(const std::string &checkpoint); //!< restore system from binary checkpoint file
     void move();
+
+    /**
+     * @brief Replica exchange with a simulation in the same process
+     * @param other Simulation to exchange configurations with
+     * @param random Random number generator for the acceptance
+     * @param context Context of this simulation; used and updated during the exchange
+     * @param other_context Context of `other`; used and updated during the exchange
+     */
+    bool exchange(MCSimulation &other, Random &random, Context &context, Context &other_context);
     void to_json(json &j);
 };
 
 void to_json(json &j, MCSimulation &mc);
 
+#ifdef DOCTEST_LIBRARY_INCLUDED
+TEST_CASE("[Faunus] MCSimulation::exchange") {
+    using doctest::Approx;
+    atoms = R"([{ "A": { "sigma": 2.0 } }])"_json.get<decltype(atoms)>();
+    molecules = R"([{ "M": { "atoms": ["A"], "atomic": true } }])"_json.get<decltype(molecules)>();
+    auto input = [](double k) { // harmonic potential, u = k r^2 / 2
+        json j = R"({
+            "geometry": {"type": "cuboid", "length": [20, 20, 20]},
+            "insertmolecules": [ { "M": { "N": 1 } } ],
+            "energy": [ { "confine": { "type": "sphere", "radius": 0, "molecules": ["M"] } } ],
+            "moves": []
+        })"_json;
+        j["energy"][0]["confine"]["k"] = k;
+        return j;
+    };
+    MCSimulation a(input(1.0), MPI::mpi), b(input(1000.0), MPI::mpi);
+    a.space().p[0].pos = {1, 0, 0};
+    b.space().p[0].pos = {2, 0, 0};
+    Change change;
+    change.all = true;
+    auto u = [](double k, double r) { return 0.5 * k * 1.0_kJmol * r * r; };
+    Random random;
+    Context context_a = Context::current(), context_b = context_a;
+    context_a.prefix = "replica0.";
+    context_b.prefix = "replica1.";
+    const auto prefix = MPI::prefix;
+
+    // du = 1.5 (ka - kb) kJ/mol is large and negative: always accepted
+    CHECK(a.exchange(b, random, context_a, context_b));
+    CHECK(MPI::prefix == prefix); // context of the caller is restored
+    CHECK(context_b.prefix == "replica1.");
+    CHECK(a.space().p[0].pos.x() == Approx(2));
+    CHECK(b.space().p[0].pos.x() == Approx(1));
+    CHECK(a.pot().energy(change) == Approx(u(1.0, 2)));
+    CHECK(b.pot().energy(change) == Approx(u(1000.0, 1)));
+
+    // exchanging back is large and positive: rejected and configurations swapped back
+    CHECK(not b.exchange(a, random, context_b, context_a));
+    CHECK(a.space().p[0].pos.x() == Approx(2));
+    CHECK(b.space().p[0].pos.x() == Approx(1));
+    CHECK(a.pot().energy(change) == Approx(u(1.0, 2)));
+    CHECK(b.pot().energy(change) == Approx(u(1000.0, 1)));
+}
+#endif
+
 /**
  * @brief Ideal energy contribution of a speciation move
  * This funciton calculates the contribution to the energy change arising from the
@@ -1,6 +1,7 @@
 #include "core.h"
 #include "move.h"
 #include "speciation.h"
+#include "energy.h"
 #include "clustermove.h"
 #include "chainmove.h"
 #include "aux/iteratorsupport.h"
@@ -10,7 +11,7 @@
 namespace Faunus {
 namespace Move {
 
-Random Movebase::slump; // static instance of Random (shared for all moves)
+thread_local Random Movebase::slump; // static instance of Random (shared for all moves)
 
 void Movebase::from_json(const json &j) {
     auto it = j.find("repeat");
@@ -63,6 +64,8 @@ void Movebase::reject(Change &c) {
     timer.stop();
 }
 
+double Movebase::walltime() const { return timer.duration().count(); }
+
 double Movebase::bias(Change &, double, double) {
     return 0; // du
 }
@@ -208,7 +211,11 @@ Propagator::Propagator(const json &j, Space &spc, MPI::MPIController &mpi) {
                     // new moves go here...
 #ifdef ENABLE_MPI
                 else if (it.key() == "temper")
-                    _moves.emplace_back<Move::ParallelTempering>(spc, mpi);
+                    _moves.emplace_back<Move::ParallelTempering>(
+                        spc, mpi,
+                        json({{"temperature", pc::temperature / 1.0_K}, {"energy", j.value("energy", json::array())}}));
+                else if (it.key() == "domaintranslate")
+                    _moves.emplace_back<Move::DomainTranslate>(spc, mpi);
                     // new moves requiring MPI go here...
 #endif
                 if (_moves.size() == oldsize + 1) {
@@ -221,6 +228,24 @@ Propagator::Propagator(const json &j, Space &spc, MPI::MPIController &mpi) {
             }
         }
     }
+
+#ifdef ENABLE_MPI
+    // halo exchanges are collective and must be reached at the same move attempt on all ranks
+    if (not _moves.find<Move::DomainTranslate>().empty() and _moves.size() > 1)
+        throw std::runtime_error("domaintranslate must be the only move");
+#endif
+
+    auto it = j.find("adaptive_moves");
+    if (it != j.end()) {
+        adaptive.enabled = true;
+        adaptive.nequil = it->at("nequil").get<unsigned long>();
+        adaptive.nupdate = it->value("nupdate", adaptive.nupdate);
+        adaptive.minfraction = it->value("minfraction", adaptive.minfraction);
+        if (adaptive.nupdate == 0 or adaptive.minfraction <= 0 or adaptive.minfraction > 1)
+            throw std::runtime_error("adaptive_moves: nupdate must be positive and minfraction in ]0:1]");
+        adaptive.weights0 = _weights;
+        adaptive.du2.resize(_moves.size());
+    }
 }
 
 void Propagator::addWeight(double weight) {
@@ -229,8 +254,82 @@ void Propagator::addWeight(double weight) {
     _repeat = int(std::accumulate(_weights.begin(), _weights.end(), 0.0));
 }
 
+void Propagator::update(decltype(_moves.vec)::iterator mv, double du) {
+    if (adaptive.enabled) {
+        if (std::isfinite(du))
+            adaptive.du2.at(std::distance(_moves.begin(), mv)) += du * du;
+        adaptive.steps++;
+        if (adaptive.steps % adaptive.nupdate == 0)
+            adapt();
+        if (adaptive.steps >= adaptive.nequil) {
+            adaptive.enabled = false;
+            faunus_logger->info("adaptive move weights fixed after {} attempts", adaptive.steps);
+        }
+    }
+}
+
+void Propagator::adapt() {
+    std::vector<double> efficiency(_moves.size(), 0);
+    for (size_t i = 0; i < _moves.size(); i++) {
+        auto &move = _moves.at(i);
+        if (move->attempts() > 0 and move->walltime() > 0 and not adaptive.du2[i].empty())
+            efficiency[i] = adaptive.du2[i].avg() / (move->walltime() / move->attempts());
+    }
+#ifdef ENABLE_MPI
+    // timings differ among ranks; use the average to keep the move selection in sync
+    if (MPI::mpi.nproc() > 1)
+        for (auto &e : efficiency)
+            e = MPI::reduceDouble(MPI::mpi, e) / MPI::mpi.nproc();
+#endif
+    double sum = 0;
+    for (size_t i = 0; i < _moves.size(); i++)
+        sum += adaptive.weights0[i] * efficiency[i];
+    if (sum <= 0 or not std::isfinite(sum))
+        return; // no information yet; keep current weights
+
+    // new weights are normalized to the original total weight
+    double total = std::accumulate(adaptive.weights0.begin(), adaptive.weights0.end(), 0.0);
+    for (size_t i = 0; i < _moves.size(); i++)
+        _weights[i] = std::max(adaptive.minfraction * adaptive.weights0[i],
+                               total * adaptive.weights0[i] * efficiency[i] / sum);
+    distribution = std::discrete_distribution<>(_weights.begin(), _weights.end());
+    faunus_logger->debug("adaptive move weights: {}", vec2words(_weights));
+}
+
 void to_json(json &j, const Propagator &propagator) {
     j = propagator._moves;
+    if (not propagator.adaptive.weights0.empty()) // adaptive weights were used
+        for (size_t i = 0; i < propagator._moves.size(); i++) {
+            auto &_j = j[i][propagator._moves.at(i)->name];
+            _j["weight"] = _round(propagator._weights[i]);
+            _j["initial weight"] = propagator.adaptive.weights0[i];
+        }
+}
+
+void unpackPositions(Space &spc, const std::vector<double> &received, const std::vector<int> &group_of,
+                     Change &change) {
+    std::map<int, std::vector<int>> touched; // group index -> atom indices
+    for (size_t i = 0; i < received.size(); i += 4) {
+        int index = int(received[i]);
+        Point pos(received[i + 1], received[i + 2], received[i + 3]);
+        auto &p = spc.p.at(index);
+        if (p.pos != pos) {
+            p.pos = pos;
+            int g = group_of.at(index);
+            touched[g].push_back(index - Faunus::distance(spc.p.begin(), spc.groups[g].begin()));
+        }
+    }
+    for (auto &t : touched) {
+        auto &g = spc.groups[t.first];
+        if (not g.atomic)
+            g.cm = Geometry::massCenter(g.begin(), g.end(), spc.geo.getBoundaryFunc(), -g.cm);
+        Change::data d;
+        d.index = t.first;
+        d.internal = true;
+        std::sort(t.second.begin(), t.second.end()); // energies look up atoms by binary search
+        d.atoms.assign(t.second.begin(), std::unique(t.second.begin(), t.second.end()));
+        change.groups.push_back(d);
+    }
 }
 
 #ifdef ENABLE_MPI
@@ -250,7 +349,10 @@ bool ParallelTempering::goodPartner() {
     return false;
 }
 void ParallelTempering::_to_json(json &j) const {
-    j = {{"replicas", mpi.nproc()}, {"datasize", pt.getFormat()}};
+    if (mode == ExchangeMode::LABEL)
+        j = {{"replicas", mpi.nproc()}, {"mode", "label"}, {"label", label}};
+    else
+        j = {{"replicas", mpi.nproc()}, {"datasize", pt.getFormat()}};
     json &_j = j["exchange"];
     _j = json::object();
     for (auto &m : accmap)
@@ -259,6 +361,15 @@ void ParallelTempering::_to_json(json &j) const {
 void ParallelTempering::_move(Change &change) {
     double Vold = spc.geo.getVolume();
     findPartner();
+    if (mode == ExchangeMode::LABEL) {
+        shared_random = mpi.random(); // drawn on all ranks to keep mpi.random in sync
+        if (goodPartner()) {
+            change.all = true; // nothing is moved; energies are exchanged in `bias()`
+            std::vector<MPI::FloatTransmitter::floatp> mylabel = {double(label)};
+            partner_label = int(ft.swapf(mpi, mylabel, partner).at(0));
+        }
+        return;
+    }
     Tpvec p; // temperary storage
     p.resize(spc.p.size());
     if (goodPartner()) {
@@ -301,32 +412,230 @@ double ParallelTempering::exchangeEnergy(double mydu) {
     duPartner = ft.swapf(mpi, duSelf, partner);
     return duPartner.at(0); // return partner energy change
 }
+/**
+ * A foreign label is evaluated using a Hamiltonian constructed from the input of the
+ * replica owning the label, and with its temperature. These are created once and kept.
+ */
+double ParallelTempering::labelEnergy(int l) {
+    auto it = hamiltonians.find(l);
+    if (it == hamiltonians.end()) {
+        auto temperature = pc::temperature;
+        pc::temperature = labels.at(l).at("temperature").get<double>() * 1.0_K;
+        auto pot = std::make_shared<Energy::Hamiltonian>(spc, labels.at(l).at("energy"));
+        pc::temperature = temperature;
+        pot->key = Energy::Energybase::NEW;
+        it = hamiltonians.emplace(l, pot).first;
+    }
+    Change change;
+    change.all = true;
+    it->second->init();
+    return it->second->energy(change);
+}
+/**
+ * In label mode the configuration is untouched and `uold` is the energy with the current label.
+ * With labels _i_ (mine) and _j_ (partner), both ranks compute the same
+ * \f$ \Delta U = u_j(x_i) - u_i(x_i) + u_i(x_j) - u_j(x_j) \f$ and use a shared random
+ * number so that the partners always agree on acceptance.
+ */
 double ParallelTempering::bias(Change &, double uold, double unew) {
+    if (mode == ExchangeMode::LABEL) {
+        double mydu = labelEnergy(partner_label) - uold;
+        double du = mydu + exchangeEnergy(mydu);
+        return (shared_random > std::exp(-du)) ? pc::infty : -pc::infty;
+    }
     return exchangeEnergy(unew - uold); // Exchange dU with partner (MPI)
 }
 std::string ParallelTempering::id() {
+    int a = mpi.rank(), b = partner;
+    if (mode == ExchangeMode::LABEL) {
+        a = label;
+        b = partner_label;
+    }
     std::ostringstream o;
-    if (mpi.rank() < partner)
-        o << mpi.rank() << " <-> " << partner;
-    else
-        o << partner << " <-> " << mpi.rank();
+    o << std::min(a, b) << " <-> " << std::max(a, b);
     return o.str();
 }
 void ParallelTempering::_accept(Change &) {
-    if (goodPartner())
+    if (goodPartner()) {
         accmap[id()] += 1;
+        if (mode == ExchangeMode::LABEL) {
+            label = partner_label;
+            if (relabel)
+                relabel(labels.at(label));
+            labelstream << cnt << " " << label << "\n";
+        }
+    }
 }
+int ParallelTempering::currentLabel() const { return (mode == ExchangeMode::LABEL) ? label : -1; }
 void ParallelTempering::_reject(Change &) {
     if (goodPartner())
         accmap[id()] += 0;
 }
-void ParallelTempering::_from_json(const json &j) { pt.setFormat(j.value("format", std::string("XYZQI"))); }
-ParallelTempering::ParallelTempering(Space &spc, MPI::MPIController &mpi) : spc(spc), mpi(mpi) {
+void ParallelTempering::_from_json(const json &j) {
+    pt.setFormat(j.value("format", std::string("XYZQI")));
+    std::string _mode = j.value("mode", std::string("configuration"));
+    if (_mode == "label") {
+        mode = ExchangeMode::LABEL;
+        labels.clear();
+        for (auto &str : MPI::allgather(mpi, input.dump()))
+            labels.push_back(json::parse(str));
+        for (auto &l : labels)
+            for (auto &term : l.at("energy"))
+                if (term.count("penalty") == 1)
+                    throw std::runtime_error("penalty energy cannot be used with label exchange");
+        labelstream.open(MPI::prefix + "temper_labels.dat");
+        if (not labelstream)
+            throw std::runtime_error("cannot open label file");
+        labelstream << "# attempt label\n0 " << label << "\n";
+    } else if (_mode != "configuration")
+        throw std::runtime_error("unknown mode: " + _mode);
+}
+ParallelTempering::ParallelTempering(Space &spc, MPI::MPIController &mpi, const json &input)
+    : spc(spc), mpi(mpi), input(input) {
     name = "temper";
     partner = -1;
+    label = mpi.rank();
+    partner_label = -1;
     pt.recvExtra.resize(1);
     pt.sendExtra.resize(1);
 }
+
+double DomainTranslate::domainPosition(double z, int rank) const {
+    double L = spc.geo.getLength().z();
+    double width = L / mpi.nproc();
+    double z0 = -0.5 * L + offset + rank * width;
+    return std::fmod(std::fmod(z - z0, L) + L, L);
+}
+void DomainTranslate::setupPhase() {
+    double halfwidth = 0.5 * spc.geo.getLength().z() / mpi.nproc();
+    candidates.clear();
+    for (auto &g : spc.findMolecules(molid, Space::ACTIVE)) {
+        int index = Faunus::distance(spc.groups.begin(), &g);
+        for (auto p = g.begin(); p != g.end(); ++p) {
+            double z = domainPosition(p->pos.z(), mpi.rank()) - phase * halfwidth;
+            if (z >= 0 and z < halfwidth)
+                candidates.push_back({index, int(std::distance(g.begin(), p))});
+        }
+    }
+}
+std::vector<double> DomainTranslate::pack(int rank) const {
+    double width = spc.geo.getLength().z() / mpi.nproc();
+    std::vector<double> v;
+    for (auto &g : spc.groups)
+        for (auto p = g.begin(); p != g.end(); ++p)
+            if (domainPosition(p->pos.z(), rank) < width)
+                v.insert(v.end(), {double(std::distance(spc.p.begin(), p)), p->pos.x(), p->pos.y(), p->pos.z()});
+    return v;
+}
+/**
+ * Own particles are sent to both neighbors and theirs are received, using non-blocking
+ * point-to-point communication, or, every `gather` phase, exchanged among all ranks.
+ * Received particles are added to `change` and the decomposition is then shifted.
+ */
+void DomainTranslate::exchange(Change &change) {
+    std::vector<double> mine = pack(mpi.rank()), received;
+    if (gather > 0 and ++phases % gather == 0) {
+        int size = mine.size();
+        std::vector<int> sizes(mpi.nproc()), offsets(mpi.nproc(), 0);
+        MPI_Allgather(&size, 1, MPI_INT, sizes.data(), 1, MPI_INT, mpi.comm);
+        for (size_t i = 1; i < sizes.size(); i++)
+            offsets[i] = offsets[i - 1] + sizes[i - 1];
+        received.resize(offsets.back() + sizes.back());
+        MPI_Allgatherv(mine.data(), size, MPI_DOUBLE, received.data(), sizes.data(), offsets.data(), MPI_DOUBLE,
+                       mpi.comm);
+    } else {
+        int up = (mpi.rank() + 1) % mpi.nproc(), down = (mpi.rank() + mpi.nproc() - 1) % mpi.nproc();
+        MPI_Request requests[2];
+        MPI_Isend(mine.data(), mine.size(), MPI_DOUBLE, up, 0, mpi.comm, &requests[0]);
+        MPI_Isend(mine.data(), mine.size(), MPI_DOUBLE, down, 1, mpi.comm, &requests[1]);
+        for (int tag : {0, 1}) { // from down (sent "up") and from up (sent "down")
+            MPI_Status status;
+            int count;
+            MPI_Probe((tag == 0) ? down : up, tag, mpi.comm, &status);
+            MPI_Get_count(&status, MPI_DOUBLE, &count);
+            size_t n = received.size();
+            received.resize(n + count);
+            MPI_Recv(received.data() + n, count, MPI_DOUBLE, status.MPI_SOURCE, tag, mpi.comm, MPI_STATUS_IGNORE);
+        }
+        MPI_Waitall(2, requests, MPI_STATUSES_IGNORE);
+    }
+
+    unpackPositions(spc, received, group_of, change);
+    halo += received.size() / 4;
+    forced = true;
+
+    phase = 1 - phase;
+    offset = 0.5 * spc.geo.getLength().z() / mpi.nproc() * mpi.random(); // identical on all ranks
+    setupPhase();
+}
+void DomainTranslate::_move(Change &change) {
+    forced = outside = false;
+    if (++attempts % nphase == 0)
+        exchange(change);
+    else if (not candidates.empty()) {
+        auto &c = candidates[slump.range(0, candidates.size() - 1)];
+        cdata.index = c.first;
+        cdata.atoms[0] = c.second;
+        auto p = spc.groups[c.first].begin() + c.second;
+        translateParticle(p, atoms.at(p->id).dp);
+        double halfwidth = 0.5 * spc.geo.getLength().z() / mpi.nproc();
+        double z = domainPosition(p->pos.z(), mpi.rank()) - phase * halfwidth;
+        outside = (z < 0 or z >= halfwidth); // confine to active half
+        change.groups.push_back(cdata);
+    }
+}
+void DomainTranslate::_accept(Change &change) {
+    if (not forced)
+        AtomicTranslateRotate::_accept(change);
+}
+double DomainTranslate::bias(Change &, double, double) {
+    if (forced)
+        return -pc::infty; // halo updates are always accepted
+    return (outside) ? pc::infty : 0;
+}
+void DomainTranslate::_to_json(json &j) const {
+    AtomicTranslateRotate::_to_json(j);
+    j["domains"] = mpi.nproc();
+    j["cutoff"] = cutoff;
+    j["phase"] = nphase;
+    j["gather"] = gather;
+    j["halo"] = halo.avg();
+    _roundjson(j, 3);
+}
+void DomainTranslate::_from_json(const json &j) {
+    try {
+        AtomicTranslateRotate::_from_json({{"molecule", j.at("molecule")}, {"dir", j.value("dir", dir)}});
+        cutoff = j.at("cutoff").get<double>();
+        nphase = j.value("phase", 1000);
+        gather = j.value("gather", 0);
+        if (spc.geo.type != Geometry::CUBOID)
+            throw std::runtime_error("cuboid geometry required");
+        if (0.5 * spc.geo.getLength().z() / mpi.nproc() < cutoff)
+            throw std::runtime_error("half domain width must be larger than cutoff");
+        if (nphase < 2)
+            throw std::runtime_error("phase must be larger than one");
+        group_of.resize(spc.p.size());
+        for (size_t i = 0; i < spc.groups.size(); i++)
+            for (auto p = spc.groups[i].begin(); p != spc.groups[i].trueend(); ++p)
+                group_of[std::distance(spc.p.begin(), p)] = i;
+        setupPhase();
+    } catch (std::exception &e) {
+        throw std::runtime_error(name + ": " + e.what());
+    }
+}
+DomainTranslate::DomainTranslate(Space &spc, MPI::MPIController &mpi) : AtomicTranslateRotate(spc), mpi(mpi) {
+    name = "domaintranslate";
+    repeat = 1;
+}
+void DomainTranslate::checkRange(const Energy::Hamiltonian &pot) const {
+    if (pot.interactsBeyond(cutoff))
+        throw std::runtime_error(name + ": cutoff is shorter than the interaction range of the Hamiltonian");
+}
+double DomainTranslate::drift(double drift) const {
+    drift = std::isnan(drift) ? pc::infty : std::fabs(drift);
+    MPI_Allreduce(MPI_IN_PLACE, &drift, 1, MPI_DOUBLE, MPI_MAX, mpi.comm);
+    return drift;
+}
 #endif
 
 void VolumeMove::_to_json(json &j) const {
@@ -395,6 +704,7 @@ void ChargeMove::_move(Change &change) {
         double qold = p.charge;
         p.charge += dq * (slump() - 0.5);
         deltaq = p.charge - qold;
+        change.chargeMove = true;
         change.groups.push_back(cdata); // add to list of moved groups
     } else
         deltaq = 0;
@@ -749,6 +1059,7 @@ void AtomicSwapCharge::_move(Change &change) {
         double oldcharge = p->charge;
         p->charge = fabs(oldcharge - 1);
         _sqd = fabs(oldcharge - 1) - oldcharge;
+        change.chargeMove = true;
         change.groups.push_back(cdata);   // add to list of moved groups
         _bias = _sqd * (pH - pKa) * ln10; // one may add bias here...
     }
@@ -6,9 +6,14 @@
 #include "geometry.h"
 #include "auxiliary.h"
 #include "space.h"
+#include <thread>
 
 namespace Faunus {
 
+namespace Energy {
+class Hamiltonian;
+}
+
 namespace Move {
 
 class Movebase {
@@ -26,7 +31,7 @@ class Movebase {
     unsigned long rejected = 0;
 
   public:
-    static Random slump; //!< Shared for all moves
+    static thread_local Random slump; //!< Shared for all moves (one per thread, see `Context`)
     std::string name;    //!< Name of move
     std::string cite;    //!< Reference
     int repeat = 1;      //!< How many times the move should be repeated per sweep
@@ -36,6 +41,8 @@ class Movebase {
     void move(Change &change);   //!< Perform move and modify given change object
     void accept(Change &c);
     void reject(Change &c);
+    unsigned long attempts() const { return cnt; } //!< Number of move attempts
+    double walltime() const; //!< Wall time spent in move including energy evaluation (microseconds)
     virtual double bias(Change &, double uold,
                         double unew); //!< adds extra energy change not captured by the Hamiltonian
     inline virtual ~Movebase() = default;
@@ -396,6 +403,19 @@ class QuadrantJump : public Movebase {
     QuadrantJump(Space &spc);
 };
 
+/**
+ * @brief Update positions from a packed buffer and register the changed particles
+ * @param spc Space to update
+ * @param received Sequence of particle index, x, y, z
+ * @param group_of Group index of each particle in `spc.p`
+ * @param change Changed groups are appended, each with a sorted, unique list of changed atoms
+ *
+ * Used by `DomainTranslate` for halo updates. Particles with unchanged positions are ignored
+ * and mass centers of changed, molecular groups are updated.
+ */
+void unpackPositions(Space &spc, const std::vector<double> &received, const std::vector<int> &group_of,
+                     Change &change);
+
 #ifdef ENABLE_MPI
 /**
  * @brief Class for parallel tempering (aka replica exchange) using MPI
@@ -406,6 +426,11 @@ class QuadrantJump : public Movebase {
  * the random number generator calls are influenced by the Hamiltonian we could
  * end up in a deadlock.
  *
+ * In label mode, configurations stay on their rank while the thermodynamic states
+ * (temperature and Hamiltonian, identified by the rank of the input they originate from)
+ * are swapped. Only labels and energies are transmitted and the actual change of Hamiltonian
+ * is left to the `relabel` callback.
+ *
  * @date Lund 2012, 2018
  */
 class ParallelTempering : public Movebase {
@@ -422,11 +447,23 @@ class ParallelTempering : public Movebase {
     MPI::FloatTransmitter ft;           //!< Class for transmitting floats over MPI
     MPI::ParticleTransmitter<Tpvec> pt; //!< Class for transmitting particles over MPI
 
+    enum class ExchangeMode { CONFIGURATION, LABEL };
+    ExchangeMode mode = ExchangeMode::CONFIGURATION;
+
+    json input;                  //!< Temperature and energy of this replica
+    std::vector<json> labels;    //!< Temperature and energy of all replicas, indexed by label
+    int label;                   //!< Label currently held by this rank
+    int partner_label;           //!< Label currently held by partner
+    double shared_random;        //!< Random number identical on all ranks
+    std::ofstream labelstream;   //!< Log of label changes, used to demultiplex output
+    std::map<int, std::shared_ptr<Energy::Hamiltonian>> hamiltonians; //!< Foreign labels operating on `spc`
+
     void findPartner(); //!< Find replica to exchange with
     bool goodPartner(); //!< Is partner valid?
     void _to_json(json &j) const override;
     void _move(Change &change) override;
     double exchangeEnergy(double mydu); //!< Exchange energy with partner
+    double labelEnergy(int l);          //!< Energy of current configuration with Hamiltonian of label `l`
     double bias(Change &, double uold, double unew) override;
     std::string id(); //!< Unique string to identify set of partners
     void _accept(Change &) override;
@@ -434,13 +471,73 @@ class ParallelTempering : public Movebase {
     void _from_json(const json &j) override;
 
   public:
-    ParallelTempering(Tspace &spc, MPI::MPIController &mpi);
+    std::function<void(const json &)> relabel; //!< Called with new temperature and energy upon label exchange
+    ParallelTempering(Tspace &spc, MPI::MPIController &mpi, const json &input);
+    int currentLabel() const; //!< Label held by this rank; -1 if configurations are exchanged
+};
+
+/**
+ * @brief Atomic translation with spatial domain decomposition over MPI ranks
+ *
+ * All ranks simulate the same system which is divided into slabs along z, one per rank.
+ * Each slab is further divided into two halves and in each _phase_, a rank moves only
+ * particles within one half, alternating between phases. Particles are
+ * confined to the active half and since it is at least one cutoff away from active
+ * halves of other ranks, no interacting particles are moved simultaneously (checkerboard).
+ *
+ * At the end of each phase, the particles of each domain are sent to both neighboring
+ * ranks (halo exchange) and the decomposition is shifted by a random, but synchronized,
+ * offset to ensure ergodicity. The halo update is always accepted, but its energy change is
+ * included to keep the drift meaningful. All positions can optionally be gathered on all
+ * ranks, e.g. for analysis, every `gather` phases.
+ *
+ * Storage is replicated, i.e. each rank holds all particles, but positions outside the domain
+ * and its neighbors are updated only upon gathering.
+ *
+ * Halo exchanges are collective and triggered by the number of move attempts. This count is
+ * identical on all ranks only if this is the only move, which is therefore enforced by `Propagator`.
+ *
+ * @warning The Hamiltonian must be short-ranged, see `checkRange()`, and the number of
+ * particles and volume must be constant.
+ */
+class DomainTranslate : public AtomicTranslateRotate {
+  private:
+    MPI::MPIController &mpi;
+    double cutoff = 0;                              //!< Maximum interaction distance
+    double offset = 0;                              //!< Shift of domain boundaries along z
+    int phase = 0;                                  //!< Active half of domain (0 = lower, 1 = upper)
+    int nphase = 0;                                 //!< Number of move attempts per phase
+    int gather = 0;                                 //!< Gather all particles every n'th phase (0 = never)
+    unsigned long attempts = 0, phases = 0;
+    bool forced = false, outside = false;           //!< Halo update in progress / particle left active half
+    std::vector<int> group_of;                      //!< Group index of each particle
+    std::vector<std::pair<int, int>> candidates;    //!< Group and atom index of particles in active half
+    Average<double> halo;                           //!< Number of particles received per halo exchange
+
+    double domainPosition(double z, int rank) const; //!< Position relative to lower bound of domain of `rank`
+    void setupPhase();                               //!< Find particles in active half
+    std::vector<double> pack(int rank) const;         //!< index, x, y, z of particles in domain of `rank`
+    void exchange(Change &change);                   //!< Halo exchange (or gather) at end of phase
+    void _move(Change &change) override;
+    void _accept(Change &change) override;
+    void _to_json(json &j) const override;
+    void _from_json(const json &j) override;
+    double bias(Change &, double, double) override;
+
+  public:
+    DomainTranslate(Space &spc, MPI::MPIController &mpi);
+    double drift(double drift) const; //!< Largest absolute drift of all ranks; NaN counts as infinite
+    void checkRange(const Energy::Hamiltonian &pot) const; //!< Throw if `pot` interacts beyond the cutoff
 };
 #endif
 
 /**
  * @brief Class storing a list of MC moves with their probability weights and
  * randomly selecting one.
+ *
+ * If `adaptive_moves` is given in the input, the selection weights are periodically
+ * updated during equilibration to maximize the decorrelation per CPU-second, see
+ * `AdaptiveWeights`. The total number of moves per MC step, `repeat()`, is unaffected.
  */
 class Propagator {
   private:
@@ -450,11 +547,40 @@ class Propagator {
     std::vector<double> _weights;       //!< list of weights for each move
     void addWeight(double weight = 1);
 
+    /**
+     * @brief Adaptive move weights
+     *
+     * The efficiency of each move type is estimated as the mean squared energy change per attempt
+     * (zero if rejected), divided by the average wall time per attempt as measured by the move
+     * timers. Weights are set proportional to the user weights times the efficiency, bounded
+     * from below by `minfraction` times the user weight to retain ergodicity. Adaptation stops
+     * after `nequil` attempts whereafter weights are fixed and detailed balance is recovered.
+     * With MPI, efficiencies are averaged over all ranks so that the move selection driven by
+     * `MPI::mpi.random` stays synchronized.
+     */
+    struct AdaptiveWeights {
+        bool enabled = false;
+        unsigned long nequil = 0;         //!< Number of move attempts during which weights are adapted
+        unsigned long nupdate = 1000;     //!< Update weights every n'th move attempt
+        unsigned long steps = 0;          //!< Move attempts since start
+        double minfraction = 0.05;        //!< Minimum weight relative to the user supplied weight
+        std::vector<double> weights0;     //!< User supplied weights
+        std::vector<Average<double>> du2; //!< Squared energy change per attempt for each move
+    } adaptive;
+    void adapt(); //!< Update move weights from collected statistics
+
   public:
     Propagator() = default;
     Propagator(const json &j, Space &spc, MPI::MPIController &mpi);
     auto repeat() const -> decltype(_repeat) { return _repeat; }
     auto moves() const -> const decltype(_moves) & { return _moves; };
+
+    /**
+     * @brief Register outcome of a move attempt used for adaptive move weights
+     * @param mv Iterator to move, as returned by `sample()`
+     * @param du Energy change of the attempt; zero if rejected
+     */
+    void update(decltype(_moves.vec)::iterator mv, double du);
     auto sample() {
         int d;
         if (!_moves.empty()) {
@@ -477,6 +603,79 @@ class Propagator {
 
 void to_json(json &j, const Propagator &propagator);
 
+#ifdef DOCTEST_LIBRARY_INCLUDED
+TEST_CASE("[Faunus] Propagator") {
+    using doctest::Approx;
+    atoms = R"([{ "A": { "sigma": 2.0, "dp": 1.0 } }])"_json.get<decltype(atoms)>();
+    molecules = R"([{ "M": { "atoms": ["A"], "atomic": true } }])"_json.get<decltype(molecules)>();
+    Space spc = R"({
+        "geometry": {"type": "cuboid", "length": [10, 10, 10]},
+        "insertmolecules": [ { "M": { "N": 10 } } ]
+    })"_json;
+    json j = R"({
+        "moves": [ { "transrot": { "molecule": "M", "repeat": 1 } },
+                   { "transrot": { "molecule": "M", "repeat": 3 } } ],
+        "adaptive_moves": { "nequil": 100, "nupdate": 10, "minfraction": 0.5 }
+    })"_json;
+    Propagator propagator(j, spc, MPI::mpi);
+    Change change;
+    auto run = [&](int attempts, int productive) { // only move `productive` changes the energy
+        for (int i = 0; i < attempts; i++) {
+            auto mv = propagator.sample();
+            (**mv).move(change);
+            std::this_thread::sleep_for(std::chrono::microseconds(20)); // ensure non-zero wall time
+            (**mv).accept(change);
+            bool is_productive = (mv == propagator.moves().begin() + productive);
+            propagator.update(mv, is_productive ? 1.0 : 0.0);
+        }
+    };
+
+    // efficiency of second move is zero so its weight is set by the `minfraction` floor,
+    // while the first move takes the rest of the total weight
+    run(100, 0);
+    json out = propagator;
+    CHECK(out[0]["transrot"]["weight"] == Approx(4.0));
+    CHECK(out[0]["transrot"]["initial weight"] == Approx(1.0));
+    CHECK(out[1]["transrot"]["weight"] == Approx(0.5 * 3.0));
+    CHECK(out[1]["transrot"]["initial weight"] == Approx(3.0));
+
+    // weights are fixed after `nequil` attempts even if efficiencies change
+    run(100, 1);
+    out = propagator;
+    CHECK(out[0]["transrot"]["weight"] == Approx(4.0));
+    CHECK(out[1]["transrot"]["weight"] == Approx(1.5));
+}
+
+TEST_CASE("[Faunus] unpackPositions") {
+    atoms = R"([{ "A": { "sigma": 2.0 } }])"_json.get<decltype(atoms)>();
+    molecules = R"([{ "M": { "atoms": ["A"], "atomic": true } },
+                    { "D": { "structure": [ {"A": [0, 0, 0]}, {"A": [1, 0, 0]} ] } }])"_json
+                    .get<decltype(molecules)>();
+    Space spc = R"({
+        "geometry": {"type": "cuboid", "length": [10, 10, 10]},
+        "insertmolecules": [ { "M": { "N": 4 } }, { "D": { "N": 1 } } ]
+    })"_json;
+    std::vector<int> group_of = {0, 0, 0, 0, 1, 1};
+    for (auto &p : spc.p)
+        p.pos.setZero();
+    spc.groups[1].cm.setZero();
+
+    // unsorted and repeated indices; particle 0 is unchanged
+    std::vector<double> received = {3, 1, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 3, 1.5, 0, 0, 5, 2, 0, 0};
+    Change change;
+    unpackPositions(spc, received, group_of, change);
+    REQUIRE(change.groups.size() == 2);
+    CHECK(change.groups[0].index == 0);
+    CHECK(change.groups[0].atoms == Change::Tindex({1, 3}));
+    CHECK(change.groups[0].internal);
+    CHECK(change.groups[1].index == 1);
+    CHECK(change.groups[1].atoms == Change::Tindex({1}));
+    CHECK(spc.p[3].pos.x() == Approx(1.5)); // last one wins
+    CHECK(spc.p[5].pos.x() == Approx(2));
+    CHECK(spc.groups[1].cm.x() == Approx(1)); // mass center is updated
+}
+#endif
+
 } // namespace Move
 
 
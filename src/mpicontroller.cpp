@@ -68,6 +68,21 @@ namespace Faunus {
             return sum;
         }
 
+        std::vector<std::string> allgather(MPIController &mpi, const std::string &local) {
+            int size = local.size();
+            std::vector<int> sizes(mpi.nproc()), offsets(mpi.nproc(), 0);
+            MPI_Allgather(&size, 1, MPI_INT, sizes.data(), 1, MPI_INT, mpi.comm);
+            for (size_t i = 1; i < sizes.size(); i++)
+                offsets[i] = offsets[i - 1] + sizes[i - 1];
+            std::vector<char> buffer(offsets.back() + sizes.back());
+            MPI_Allgatherv(local.data(), size, MPI_CHAR, buffer.data(), sizes.data(), offsets.data(), MPI_CHAR,
+                           mpi.comm);
+            std::vector<std::string> v;
+            for (size_t i = 0; i < sizes.size(); i++)
+                v.emplace_back(buffer.data() + offsets[i], sizes[i]);
+            return v;
+        }
+
         FloatTransmitter::FloatTransmitter() {
             tag=0;
         }
@@ -110,7 +125,7 @@ namespace Faunus {
 #endif
 
         // global instances
-        std::string prefix;
+        thread_local std::string prefix;
         MPIController mpi;
 
     } // namespace
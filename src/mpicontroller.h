@@ -30,7 +30,7 @@ namespace Faunus {
      */
     namespace MPI {
 
-        extern std::string prefix;
+        extern thread_local std::string prefix; //!< File prefix (one per thread, see `Context`)
 
         /**
          * @brief Main controller for MPI calls
@@ -103,6 +103,14 @@ namespace Faunus {
          */
         double reduceDouble(MPIController &mpi, double local);
 
+        /**
+         * @brief Gather a string from all ranks
+         *
+         * Returns a vector with the string of each rank, indexed by rank.
+         * This is a collective call and must be made by all ranks.
+         */
+        std::vector<std::string> allgather(MPIController &mpi, const std::string &local);
+
         /*!
          * \brief Class for transmitting floating point arrays over MPI
          * \note If you change the floatp typedef, remember also to change to change to/from
@@ -77,12 +77,25 @@ Particle::Particle(const AtomData &a) { *this = json(a).front(); }
 
 Particle::Particle(const AtomData &a, const Point &pos) : Particle(a) { this->pos = pos; }
 
+/**
+ * Extensions are allocated from a thread local pool so that copying and
+ * destroying particles, e.g. during `Space::sync()`, recycle memory rather
+ * than calling the system allocator for every particle.
+ */
+template <typename... Args> static std::shared_ptr<Particle::ParticleExtension> makeExtension(Args &&... args) {
+    return std::allocate_shared<Particle::ParticleExtension>(PoolAllocator<Particle::ParticleExtension>(),
+                                                             std::forward<Args>(args)...);
+}
+
 // copy constructor
 Particle::Particle(const Particle &p) : id(p.id), charge(p.charge), pos(p.pos) {
     if (p.ext != nullptr)
-        ext = std::make_shared<Particle::ParticleExtension>(*p.ext); // deep copy
+        ext = makeExtension(*p.ext); // deep copy
 }
 
+// move constructor
+Particle::Particle(Particle &&p) noexcept : ext(std::move(p.ext)), id(p.id), charge(p.charge), pos(p.pos) {}
+
 // assignment operator
 Particle &Particle::operator=(const Particle &p) {
     if (&p != this) {
@@ -93,13 +106,24 @@ Particle &Particle::operator=(const Particle &p) {
             if (ext != nullptr) // extension, then
                 *ext = *p.ext;  // deep copy
             else                // else if *this is empty, create new based on p
-                ext = std::make_shared<Particle::ParticleExtension>(*p.ext); // create new
+                ext = makeExtension(*p.ext);                                 // create new
         } else                                                               // p doesn't have extended properties
             ext = nullptr;
     }
     return *this;
 }
 
+// move assignment operator
+Particle &Particle::operator=(Particle &&p) noexcept {
+    if (&p != this) {
+        charge = p.charge;
+        pos = p.pos;
+        id = p.id;
+        ext = std::move(p.ext);
+    }
+    return *this;
+}
+
 void Particle::rotate(const Eigen::Quaterniond &q, const Eigen::Matrix3d &m) {
     if (ext != nullptr)
         ext->rotate(q, m);
@@ -109,7 +133,7 @@ bool Particle::hasExtension() const { return ext != nullptr; }
 
 Particle::ParticleExtension &Particle::createExtension() {
     assert(ext == nullptr && "extension already created");
-    ext = std::make_shared<ParticleExtension>();
+    ext = makeExtension();
     return *ext;
 }
 
@@ -118,7 +142,7 @@ void from_json(const json &j, Particle &p) {
     p.pos = j.value("pos", Point(0, 0, 0));
     p.charge = j.value("q", 0.0);
 
-    p.ext = std::make_shared<Particle::ParticleExtension>();
+    p.ext = makeExtension();
     from_json(j, *p.ext);
     Particle::ParticleExtension empty_extended_particle;
     // why can't we compare ParticleExtension directly?!
@@ -2,6 +2,7 @@
 #include "core.h"
 #include "atomdata.h"
 #include "tensor.h"
+#include "auxiliary.h"
 
 #ifdef DOCTEST_LIBRARY_INCLUDED
 #include "rotate.h"
@@ -146,6 +147,10 @@ template <typename... Properties> void from_json(const json &j, ParticleTemplate
  * from a json object, extended properties are automatically detected and
  * memory is automatically allocated
  *
+ * Extended properties are allocated from a thread local pool. Copy construction,
+ * or assignment to a particle without extensions, takes a new extension from the
+ * pool; only assignment to a particle that already has extensions reuses its memory.
+ *
  * @warning: memory model for extended properties is still in alpha phase
  */
 class Particle {
@@ -160,8 +165,10 @@ class Particle {
     Particle() = default;
     Particle(const AtomData &a);
     Particle(const AtomData &a, const Point &pos);
-    Particle(const Particle &);            //!< copy constructor
-    Particle &operator=(const Particle &); //!< assignment operator
+    Particle(const Particle &);                //!< copy constructor
+    Particle(Particle &&) noexcept;            //!< move constructor
+    Particle &operator=(const Particle &);     //!< assignment operator
+    Particle &operator=(Particle &&) noexcept; //!< move assignment operator
     void rotate(const Eigen::Quaterniond &q, const Eigen::Matrix3d &m);
 
     bool hasExtension() const; //!< check if particle has extensions (dipole etc.)
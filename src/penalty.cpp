@@ -42,6 +42,19 @@ Penalty::Penalty(const json &j, Space &spc) : spc(spc) {
     histo.reInitializer(binwidth, min, max);
     penalty.reInitializer(binwidth, min, max);
 
+    auto _walkers = j.value("walkers", std::string());
+    if (not _walkers.empty()) {
+        increments.setZero(2 * penalty.size()); // penalty followed by histogram
+        if (_walkers == "threads")
+            walkers = std::make_shared<ThreadWalkerExchange>(file, increments.size());
+#ifdef ENABLE_MPI
+        else if (_walkers == "mpi")
+            walkers = std::make_shared<MPIWalkerExchange>(MPI::mpi, increments.size());
+#endif
+        else
+            throw std::runtime_error("unknown walkers: " + _walkers);
+    }
+
     std::ifstream f(MPI::prefix + file);
     if (f) {
         faunus_logger->debug("Loading penalty function {}", MPI::prefix + file);
@@ -78,6 +91,8 @@ void Penalty::to_json(json &j) const {
     j["histogram"] = hisfile;
     j["f0_final"] = f0;
     j["overwrite"] = overwrite_penalty;
+    if (walkers)
+        j["walkers"] = (std::dynamic_pointer_cast<ThreadWalkerExchange>(walkers)) ? "threads" : "mpi";
     auto &_j = j["coords"] = json::array();
     for (auto rc : rcvec)
         _j.push_back(*rc); // `ReactionCoordinateBase` --> `json`
@@ -119,11 +134,76 @@ void Penalty::update(const std::vector<double> &c) {
     penalty[coord] += f0;
     udelta += f0;
 }
+void Penalty::increment(const std::vector<double> &c) {
+    coord = c;
+    histo[coord]++;
+    penalty[coord] += f0;
+    udelta += f0;
+    if (walkers) {
+        auto i = &penalty[coord] - penalty.data();
+        increments[i] += f0;
+        increments[penalty.size() + i] += 1;
+    }
+}
+/**
+ * Other walkers' increments are added to both penalty function and histogram whenever they
+ * arrive, while own increments are posted every `update` steps. A walker votes for reducing
+ * `f0` based on the histogram of all walkers, but the reduction, including the reset of the
+ * histogram, is decided jointly so that all walkers proceed with the same `f0`.
+ */
+bool Penalty::updateWalkers(const std::vector<double> &c) {
+    bool merged = false;
+    Eigen::VectorXd others;
+    coord = c;
+    double uold = penalty[coord];
+    if (walkers->collect(others)) {
+        Eigen::Map<Eigen::VectorXd>(penalty.data(), penalty.size()) += others.head(penalty.size());
+        Eigen::Map<Eigen::VectorXi>(histo.data(), histo.size()) += others.tail(histo.size()).cast<int>();
+        merged = true;
+    }
+    if (++cnt % nupdate == 0) {
+        walkers->post(increments);
+        increments.setZero();
+        bool ready = f0 > 0 and histo.minCoeff() >= (int)samplings;
+        for (auto shared = walkers->reductions(reductions, ready); reductions < shared; reductions++) {
+            penalty = penalty.array() - penalty.minCoeff();
+            f0 = f0 * scale;
+            samplings = std::ceil(samplings / scale);
+            histo.setZero();
+            nconv += 1;
+            merged = true;
+        }
+    }
+    udelta += penalty[coord] - uold;
+    increment(c);
+    return merged;
+}
 void Penalty::sync(Energybase *basePtr, Change &) {
     // this function is called when a move is accepted
     // or rejected, as well as when initializing the system
     auto other = dynamic_cast<decltype(this)>(basePtr);
     assert(other);
+    if (walkers) {
+        // only the accepted state communicates with other walkers while the trial state follows
+        auto primary = (key == OLD) ? this : other;
+        auto secondary = (key == OLD) ? other : this;
+        auto c = other->coord;
+        if (primary->updateWalkers(c)) {
+            secondary->penalty = primary->penalty;
+            secondary->histo = primary->histo;
+            secondary->f0 = primary->f0;
+            secondary->samplings = primary->samplings;
+            secondary->udelta = primary->udelta;
+            secondary->nconv = primary->nconv;
+            secondary->reductions = primary->reductions;
+            secondary->coord = primary->coord;
+            secondary->cnt = primary->cnt;
+        } else {
+            secondary->cnt++;
+            secondary->increment(c);
+        }
+        return;
+    }
     update(other->coord);
     other->update(other->coord); // this is to keep cnt and samplings in sync
 
@@ -134,8 +214,90 @@ void Penalty::sync(Energybase *basePtr, Change &) {
     assert(udelta == other->udelta);
 }
 
+ThreadWalkerExchange::ThreadWalkerExchange(const std::string &name, Eigen::Index size) {
+    static std::mutex mutex;
+    static std::map<std::string, std::weak_ptr<Board>> boards;
+    std::lock_guard<std::mutex> lock(mutex);
+    board = boards[name].lock();
+    if (not board) {
+        board = std::make_shared<Board>();
+        board->total.setZero(size);
+        boards[name] = board;
+    } else if (board->total.size() != size)
+        throw std::runtime_error("walkers sharing '" + name + "' must have identical penalty functions");
+    seen = board->total;
+    own.setZero(size);
+}
+void ThreadWalkerExchange::post(const Eigen::VectorXd &increments) {
+    std::lock_guard<std::mutex> lock(board->mutex);
+    board->total += increments;
+    own += increments;
+}
+bool ThreadWalkerExchange::collect(Eigen::VectorXd &increments) {
+    {
+        std::lock_guard<std::mutex> lock(board->mutex);
+        increments = board->total - seen - own;
+        seen = board->total;
+    }
+    own.setZero();
+    return not increments.isZero(0);
+}
+size_t ThreadWalkerExchange::reductions(size_t done, bool ready) {
+    std::lock_guard<std::mutex> lock(board->mutex);
+    if (ready and done == board->reductions) // first vote decides; later votes for the same reduction are void
+        board->reductions++;
+    return board->reductions;
+}
+
 #ifdef ENABLE_MPI
 
+MPIWalkerExchange::MPIWalkerExchange(MPI::MPIController &mpi, Eigen::Index size) : mpi(mpi) {
+    sendbuf.setZero(size + 1); // last element is the vote for a reduction
+    recvbuf.setZero(size + 1);
+    received.setZero(size);
+}
+MPIWalkerExchange::~MPIWalkerExchange() {
+    if (pending)
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+}
+void MPIWalkerExchange::complete() {
+    received += (recvbuf - sendbuf).head(received.size()); // exclude own contribution
+    if (recvbuf[received.size()] > 0)
+        decided++;
+    pending = false;
+    available = true;
+}
+void MPIWalkerExchange::post(const Eigen::VectorXd &increments) {
+    if (pending) { // buffers are in use until the previous reduction is done
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+        complete();
+    }
+    sendbuf.head(increments.size()) = increments;
+    sendbuf[increments.size()] = (vote and voted == decided) ? 1 : 0; // drop votes for decided reductions
+    vote = false;
+    MPI_Iallreduce(sendbuf.data(), recvbuf.data(), sendbuf.size(), MPI_DOUBLE, MPI_SUM, mpi.comm, &request);
+    pending = true;
+}
+bool MPIWalkerExchange::collect(Eigen::VectorXd &increments) {
+    if (pending) {
+        int done = 0;
+        MPI_Test(&request, &done, MPI_STATUS_IGNORE);
+        if (done)
+            complete();
+    }
+    if (not available)
+        return false;
+    increments = received;
+    received.setZero();
+    available = false;
+    return true;
+}
+size_t MPIWalkerExchange::reductions(size_t done, bool ready) {
+    vote = ready;
+    voted = done;
+    return decided;
+}
+
 PenaltyMPI::PenaltyMPI(const json &j, Space &spc) : Penalty(j, spc) {
     weights.resize(MPI::mpi.nproc());
     buffer.resize(penalty.size() * MPI::mpi.nproc()); // recieve buffer for penalty func
@@ -3,10 +3,94 @@
 #include "mpicontroller.h"
 #include "externalpotential.h"
 #include "reactioncoordinate.h"
+#include <mutex>
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+#include "space.h"
+#endif
 
 namespace Faunus {
 namespace Energy {
 
+/**
+ * @brief Asynchronous exchange of penalty function increments between multiple walkers
+ *
+ * Each walker posts its own increments without waiting for the others and later
+ * collects the summed increments of all other walkers once these have arrived.
+ * Reductions of the penalty increment are decided jointly through `reductions()`
+ * so that all walkers reduce equally often.
+ */
+class WalkerExchange {
+  public:
+    virtual ~WalkerExchange() = default;
+    virtual void post(const Eigen::VectorXd &increments) = 0; //!< Post own increments (non-blocking)
+    virtual bool collect(Eigen::VectorXd &increments) = 0;    //!< Increments from other walkers, if any arrived
+
+    /**
+     * @brief Shared number of penalty increment reductions
+     * @param done Reductions done by the calling walker
+     * @param ready True if the calling walker votes for another reduction
+     * @return Reductions decided by all walkers so far
+     */
+    virtual size_t reductions(size_t done, bool ready) = 0;
+};
+
+/**
+ * @brief Walkers running as threads in the same process
+ *
+ * All walkers using the same `name` share a board with the total sum of posted
+ * increments, guarded by a mutex that is held only while adding or reading.
+ * The first walker voting for a reduction decides it on the board.
+ */
+class ThreadWalkerExchange : public WalkerExchange {
+    struct Board {
+        std::mutex mutex;
+        Eigen::VectorXd total; //!< Sum of increments posted by all walkers
+        size_t reductions = 0; //!< Number of reductions decided by any walker
+    };
+    std::shared_ptr<Board> board;
+    Eigen::VectorXd seen; //!< Board total at last collect
+    Eigen::VectorXd own;  //!< Own increments posted since last collect
+
+  public:
+    ThreadWalkerExchange(const std::string &name, Eigen::Index size);
+    void post(const Eigen::VectorXd &increments) override;
+    bool collect(Eigen::VectorXd &increments) override;
+    size_t reductions(size_t done, bool ready) override;
+};
+
+#ifdef ENABLE_MPI
+/**
+ * @brief Walkers running in separate MPI processes
+ *
+ * Increments are summed using a non-blocking `MPI_Iallreduce`. Posting is
+ * collective and must be done equally often by all ranks; a walker waits only if
+ * the previous reduction is still incomplete. A vote for reducing the penalty
+ * increment is sent in an extra slot along with the next post and a reduction is
+ * decided when a sum with at least one vote completes. Since a post waits for the
+ * previous one, all ranks agree on the decided reductions at the time of posting,
+ * and votes cast before the latest decision are dropped.
+ */
+class MPIWalkerExchange : public WalkerExchange {
+    MPI::MPIController &mpi;
+    MPI_Request request;
+    bool pending = false;   //!< True if a reduction is in progress
+    bool available = false; //!< True if `received` holds uncollected increments
+    bool vote = false;      //!< True if voting for a reduction in the next post
+    size_t voted = 0;       //!< Reductions done by the voting walker when the vote was cast
+    size_t decided = 0;     //!< Reductions decided by completed sums
+    Eigen::VectorXd sendbuf, recvbuf, received;
+    void complete(); //!< Book-keeping for completed reduction
+
+  public:
+    MPIWalkerExchange(MPI::MPIController &mpi, Eigen::Index size);
+    ~MPIWalkerExchange();
+    void post(const Eigen::VectorXd &increments) override;
+    bool collect(Eigen::VectorXd &increments) override;
+    size_t reductions(size_t done, bool ready) override;
+};
+#endif
+
 /**
  * `udelta` is the total change of updating the energy function. If
  * not handled this will appear as an energy drift (which it is!). To
@@ -27,6 +111,7 @@ class Penalty : public Energybase {
     size_t nupdate;                // update frequency [steps]
     size_t samplings;
     size_t nconv = 0;
+    size_t reductions = 0; // reductions of f0 shared with other walkers
     double udelta = 0; // total energy change of updating penalty function
     double scale;      // scaling factor for f0
     double f0;         // penalty increment
@@ -37,6 +122,11 @@ class Penalty : public Energybase {
     Table<int> histo;      // sampling along reaction coordinates
     Table<double> penalty; // penalty function
 
+    std::shared_ptr<WalkerExchange> walkers; // asynchronous exchange with other walkers, if any
+    Eigen::VectorXd increments;              // own penalty and histogram increments since last post
+    void increment(const std::vector<double> &c);    // add penalty energy at `c`
+    bool updateWalkers(const std::vector<double> &c); // update with other walkers; true if tables merged
+
   public:
     Penalty(const json &j, Space &spc);
     virtual ~Penalty();
@@ -62,5 +152,74 @@ struct PenaltyMPI : public Penalty {
 };    //!< Penalty function with MPI exchange
 #endif
 
+#ifdef DOCTEST_LIBRARY_INCLUDED
+TEST_CASE("[Faunus] ThreadWalkerExchange") {
+    using Eigen::VectorXd;
+    ThreadWalkerExchange a("walkertest", 2), b("walkertest", 2), c("walkertest", 2);
+    CHECK_THROWS(ThreadWalkerExchange("walkertest", 3));
+    VectorXd increments;
+    CHECK(not a.collect(increments));
+
+    a.post(VectorXd::Constant(2, 1.0));
+    b.post(VectorXd::Constant(2, 2.0));
+    REQUIRE(c.collect(increments)); // sum of all others
+    CHECK(increments == VectorXd::Constant(2, 3.0));
+    REQUIRE(a.collect(increments)); // own increments are excluded
+    CHECK(increments == VectorXd::Constant(2, 2.0));
+    a.post(VectorXd::Constant(2, 4.0));
+    REQUIRE(b.collect(increments)); // both posts of `a`
+    CHECK(increments == VectorXd::Constant(2, 5.0));
+    CHECK(not b.collect(increments)); // nothing new
+    REQUIRE(c.collect(increments)); // only increments since last collect
+    CHECK(increments == VectorXd::Constant(2, 4.0));
+
+    // a reduction decided by one walker is seen by all; simultaneous votes count once
+    CHECK(a.reductions(0, false) == 0);
+    CHECK(b.reductions(0, true) == 1);
+    CHECK(c.reductions(0, true) == 1);
+    CHECK(a.reductions(0, false) == 1);
+    CHECK(a.reductions(1, false) == 1);
+    CHECK(a.reductions(1, true) == 2);
+}
+
+TEST_CASE("[Faunus] Penalty with walkers") {
+    struct Walker : public Penalty {
+        using Penalty::Penalty;
+        using Penalty::f0;
+        using Penalty::histo;
+        using Penalty::reductions;
+        using Penalty::updateWalkers;
+    };
+    atoms = R"([{ "A": { "sigma": 2.0 } }])"_json.get<decltype(atoms)>();
+    molecules = R"([{ "M": { "atoms": ["A"], "atomic": true } }])"_json.get<decltype(molecules)>();
+    Space spc = R"({
+        "geometry": {"type": "cuboid", "length": [10, 10, 10]},
+        "insertmolecules": [ { "M": { "N": 1 } } ]
+    })"_json;
+    json j = R"({
+        "f0": 0.5, "scale": 0.5, "update": 1, "samplings": 1, "walkers": "threads",
+        "file": "walkertest.penalty", "overwrite": false, "histogram": "walkertest.histogram",
+        "coords": [ {"atom": {"index": 0, "property": "x", "range": [0, 1], "resolution": 1}} ]
+    })"_json;
+    Walker a(j, spc), b(j, spc);
+    std::vector<double> bin0 = {0, 0}, bin1 = {1, 0}; // a samples only the first bin, b the second
+
+    CHECK(not a.updateWalkers(bin0));
+    CHECK(not b.updateWalkers(bin1));
+    CHECK(not a.updateWalkers(bin0)); // b's first post was empty
+    CHECK(b.histo.minCoeff() == 0);
+
+    // b sees both bins and decides a reduction
+    CHECK(b.updateWalkers(bin1));
+    CHECK(b.reductions == 1);
+    CHECK(b.f0 == doctest::Approx(0.25));
+
+    // a votes as well, but for the reduction already decided by b, which it applies once
+    CHECK(a.updateWalkers(bin0));
+    CHECK(a.reductions == 1);
+    CHECK(a.f0 == doctest::Approx(0.25));
+}
+#endif
+
 } // end of Energy namespace
 } // end of Faunus namespace
@@ -116,6 +116,39 @@ Point PairPotentialBase::force(const Particle &, const Particle &, double, const
     return {0, 0, 0};
 }
 
+// =============== InversePowerSums ===============
+
+double InversePowerSums::energy(double s) const {
+    double s2 = s * s;
+    if (s2 * hardcore < 1 or s2 * inside > 1 or s2 * outside <= 1)
+        return std::numeric_limits<double>::quiet_NaN(); // a pair may cross a hard core or cut-off
+    double s6inv = 1 / (s2 * s2 * s2);
+    return u0 + u1 / s + u6 * s6inv + u12 * s6inv * s6inv;
+}
+
+InversePowerSums InversePowerSums::scale(double s) const {
+    double s2 = s * s, s6inv = 1 / (s2 * s2 * s2);
+    InversePowerSums scaled = *this;
+    scaled.u1 /= s;
+    scaled.u6 *= s6inv;
+    scaled.u12 *= s6inv * s6inv;
+    scaled.hardcore *= s2;
+    scaled.inside *= s2;
+    scaled.outside *= s2;
+    return scaled;
+}
+
+void InversePowerSums::update(const InversePowerSums &removed, const InversePowerSums &added) {
+    u0 += added.u0 - removed.u0;
+    u1 += added.u1 - removed.u1;
+    u6 += added.u6 - removed.u6;
+    u12 += added.u12 - removed.u12;
+    // bounds of removed pairs cannot be retracted, leaving them conservative
+    hardcore = std::min(hardcore, added.hardcore);
+    inside = std::max(inside, added.inside);
+    outside = std::min(outside, added.outside);
+}
+
 // =============== MixerPairPotentialBase ===============
 
 void MixerPairPotentialBase::init() {
@@ -219,6 +252,12 @@ void SASApotential::from_json(const json &j) {
     shift = j.value("shift", true);
     conc = j.at("molarity").get<double>() * 1.0_molar;
     proberadius = j.value("radius", 1.4) * 1.0_angstrom;
+    tension.clear();
+    tfe.clear();
+    for (auto &a : atoms) {
+        tension.push_back(a.tension * 1.0_kJmol / (1.0_angstrom * 1.0_angstrom));
+        tfe.push_back(a.tfe * 1.0_kJmol / (1.0_angstrom * 1.0_angstrom * 1.0_molar));
+    }
 }
 
 void SASApotential::to_json(json &j) const {
@@ -131,6 +131,71 @@ struct PairPotentialBase {
 void to_json(json &j, const PairPotentialBase &base);   //!< Serialize any pair potential to json
 void from_json(const json &j, PairPotentialBase &base); //!< Serialize any pair potential from json
 
+/**
+ * @brief Pair energies decomposed into inverse powers of the separation
+ *
+ * For pair potentials built from terms proportional to r^-1, r^-6, and r^-12, and
+ * optionally a hard core or a cut-off, the energy of a configuration where all
+ * separations have been scaled by a factor `s` is obtained without visiting any pairs:
+ *
+ * @f[
+ *     U(s) = U_0 + U_1 s^{-1} + U_6 s^{-6} + U_{12} s^{-12}
+ * @f]
+ *
+ * This is exact only if no pair crosses a hard core or a cut-off upon scaling. To detect this,
+ * conservative bounds on the squared reduced separations are kept: the bounds may be
+ * outdated after pairs are removed with `update()` but never so that a crossing is missed.
+ * If a crossing cannot be ruled out, `energy()` returns NaN and the caller should fall back
+ * to a full energy calculation.
+ */
+struct InversePowerSums {
+    double u0 = 0, u1 = 0, u6 = 0, u12 = 0; //!< Energy sums of constant, r^-1, r^-6, and r^-12 terms
+    double hardcore = pc::infty;            //!< Lower bound of (r/sigma)^2 for hard core pairs
+    double inside = 0;                      //!< Upper bound of (r/rc)^2 for pairs within a cut-off
+    double outside = pc::infty;             //!< Lower bound of (r/rc)^2 for pairs beyond a cut-off
+
+    double energy(double s = 1) const; //!< Energy after scaling all separations by `s`; NaN if undetermined
+    InversePowerSums scale(double s) const; //!< Sums after scaling all separations by `s`
+    void update(const InversePowerSums &removed, const InversePowerSums &added); //!< Replace a subset of pairs
+};
+
+/**
+ * @brief Test if a pair potential can decompose energies into `InversePowerSums`
+ *
+ * This is true if the pair potential has a member function,
+ * `double decompose(const Particle&, const Particle&, const Point&, InversePowerSums&) const`,
+ * that returns the pair energy (as `operator()`) while adding it to the sums.
+ */
+template <class T, class = void> struct is_decomposable : std::false_type {};
+
+template <class T>
+struct is_decomposable<T, decltype(std::declval<const T &>().decompose(
+                                       std::declval<const Particle &>(), std::declval<const Particle &>(),
+                                       std::declval<const Point &>(), std::declval<InversePowerSums &>()),
+                                   void())> : std::true_type {};
+
+/**
+ * @brief Test if a pair potential can give the electric potential from a point charge
+ *
+ * This is true if the pair potential has a member function,
+ * `double electricPotential(double charge, const Point &r) const`, returning the potential
+ * (kT per unit charge) at distance `r` from `charge` so that the pair energy is linear in the charges.
+ */
+template <class T, class = void> struct has_electric_potential : std::false_type {};
+
+template <class T>
+struct has_electric_potential<T, decltype(std::declval<const T &>().electricPotential(
+                                              std::declval<double>(), std::declval<const Point &>()),
+                                          void())> : std::true_type {};
+
+/**
+ * @brief Test if a pair potential is independent of the particle charges
+ *
+ * Specialize for potentials where this is true; used to combine with electrostatic potentials
+ * that implement `electricPotential()`.
+ */
+template <class T> struct is_charge_independent : std::false_type {};
+
 /**
  * @brief A common ancestor for potentials that use parameter matrices computed from atomic
  * properties and/or custom atom pair properties.
@@ -173,6 +238,27 @@ template <class T1, class T2> struct CombinedPairPotential : public PairPotentia
         return first.force(a, b, r2, p) + second.force(a, b, r2, p);
     } //!< Combine force
 
+    template <class U1 = T1, class U2 = T2>
+    inline auto decompose(const Particle &a, const Particle &b, const Point &r, InversePowerSums &sums) const
+        -> decltype(std::declval<const U1 &>().decompose(a, b, r, sums) +
+                    std::declval<const U2 &>().decompose(a, b, r, sums)) {
+        return first.decompose(a, b, r, sums) + second.decompose(a, b, r, sums);
+    } //!< Combine energy decomposition; available only if both potentials can be decomposed
+
+    template <class U1 = T1, class U2 = T2>
+    inline auto electricPotential(double charge, const Point &r) const
+        -> std::enable_if_t<is_charge_independent<U2>::value,
+                            decltype(std::declval<const U1 &>().electricPotential(charge, r))> {
+        return first.electricPotential(charge, r);
+    } //!< Electric potential of first; available only if the second potential is charge independent
+
+    template <class U1 = T1, class U2 = T2>
+    inline auto electricPotential(double charge, const Point &r) const
+        -> std::enable_if_t<is_charge_independent<U1>::value,
+                            decltype(std::declval<const U2 &>().electricPotential(charge, r))> {
+        return second.electricPotential(charge, r);
+    } //!< Electric potential of second; available only if the first potential is charge independent
+
     void from_json(const json &j) override {
         Faunus::Potential::from_json(j, first);
         Faunus::Potential::from_json(j, second);
@@ -235,6 +321,15 @@ class LennardJones : public MixerPairPotentialBase {
         x = x * x * x;                                             // s6/r6
         return (*epsilon_quadruple)(a.id, b.id) * (x * x - x);
     }
+
+    inline double decompose(const Particle &a, const Particle &b, const Point &r, InversePowerSums &sums) const {
+        double x = (*sigma_squared)(a.id, b.id) / r.squaredNorm(); // s2/r2
+        x = x * x * x;                                             // s6/r6
+        double u12 = (*epsilon_quadruple)(a.id, b.id) * x * x, u6 = -(*epsilon_quadruple)(a.id, b.id) * x;
+        sums.u12 += u12;
+        sums.u6 += u6;
+        return u12 + u6;
+    } //!< Energy, also added to r^-12 and r^-6 sums
 };
 
 /**
@@ -279,6 +374,26 @@ class WeeksChandlerAndersen : public LennardJones {
         x = x * x * x; // (s/r)^6
         return (*epsilon_quadruple)(a.id, b.id) * 6 * (2 * x * x - x) / r2 * p;
     }
+
+    inline double decompose(const Particle &a, const Particle &b, const Point &r, InversePowerSums &sums) const {
+        double r2 = r.squaredNorm();
+        double x = (*sigma_squared)(a.id, b.id); // s^2
+        double rc2 = x * twototwosixth;
+        if (r2 > rc2) {
+            sums.outside = std::min(sums.outside, r2 / rc2);
+            return 0;
+        }
+        sums.inside = std::max(sums.inside, r2 / rc2);
+        x = x / r2;    // (s/r)^2
+        x = x * x * x; // (s/r)^6
+        double u0 = (*epsilon_quadruple)(a.id, b.id) * onefourth;
+        double u6 = -(*epsilon_quadruple)(a.id, b.id) * x;
+        double u12 = (*epsilon_quadruple)(a.id, b.id) * x * x;
+        sums.u0 += u0;
+        sums.u6 += u6;
+        sums.u12 += u12;
+        return u12 + u6 + u0;
+    } //!< Energy, also added to sums and cut-off bounds
 }; // Weeks-Chandler-Andersen potential
 
 /**
@@ -302,8 +417,18 @@ class HardSphere : public MixerPairPotentialBase {
     inline double operator()(const Particle &a, const Particle &b, const Point &r) const override {
         return r.squaredNorm() < (*sigma_squared)(a.id, b.id) ? pc::infty : 0.0;
     }
+
+    inline double decompose(const Particle &a, const Particle &b, const Point &r, InversePowerSums &sums) const {
+        double x = r.squaredNorm() / (*sigma_squared)(a.id, b.id); // (r/s)^2
+        sums.hardcore = std::min(sums.hardcore, x);
+        return x < 1 ? pc::infty : 0.0;
+    } //!< Energy, also updating the hard core bound
 };
 
+template <> struct is_charge_independent<LennardJones> : std::true_type {};
+template <> struct is_charge_independent<WeeksChandlerAndersen> : std::true_type {};
+template <> struct is_charge_independent<HardSphere> : std::true_type {};
+
 /**
  * @brief Hertz potential
  * @details This is a repulsive potential, that for example, describes the change in elastic energy
@@ -442,16 +567,18 @@ class SASApotential : public PairPotentialBase {
   private:
     bool shift = true; // shift potential to zero at large separations?
     double proberadius = 0, conc = 0;
+    std::vector<double> tension, tfe; // per atom type in kT, converted at the temperature of `from_json()`
 
     double area(double R, double r, double d_squared)
     const; //!< Total surface area of two intersecting spheres or radii R and r as a function of separation
 
   public:
     inline double operator()(const Particle &a, const Particle &b, const Point &r_ab) const override {
-        double tfe = 0.5 * (atoms[a.id].tfe + atoms[b.id].tfe);
-        double tension = 0.5 * (atoms[a.id].tension + atoms[b.id].tension);
-        if (fabs(tfe) > 1e-6 or fabs(tension) > 1e-6)
-            return (tension + conc * tfe) * area(0.5 * atoms[a.id].sigma, 0.5 * atoms[b.id].sigma, r_ab.squaredNorm());
+        double tfe_ab = 0.5 * (tfe[a.id] + tfe[b.id]);
+        double tension_ab = 0.5 * (tension[a.id] + tension[b.id]);
+        if (fabs(tfe_ab) > 1e-6 or fabs(tension_ab) > 1e-6)
+            return (tension_ab + conc * tfe_ab) *
+                   area(0.5 * atoms[a.id].sigma, 0.5 * atoms[b.id].sigma, r_ab.squaredNorm());
         return 0;
     }
     SASApotential(const std::string &name = "sasa", const std::string &cite = std::string()) :
@@ -466,6 +593,17 @@ struct Coulomb : public PairPotentialBase {
     inline double operator()(const Particle &a, const Particle &b, const Point &r) const override {
         return lB * a.charge * b.charge / r.norm();
     }
+
+    inline double electricPotential(double charge, const Point &r) const {
+        return lB * charge / r.norm();
+    } //!< Potential (kT per unit charge) at distance `r` from `charge`
+
+    inline double decompose(const Particle &a, const Particle &b, const Point &r, InversePowerSums &sums) const {
+        double u = operator()(a, b, r);
+        sums.u1 += u;
+        return u;
+    } //!< Energy, also added to the r^-1 sum
+
     void to_json(json &j) const override;
     void from_json(const json &j) override;
 };
@@ -500,6 +638,11 @@ class Polarizability : public Coulomb {
 
     void to_json(json &j) const override { j = {{"epsr", epsr}}; }
 
+    double decompose(const Particle &, const Particle &, const Point &,
+                     InversePowerSums &) const = delete; //!< Not an inverse power of r (as `Coulomb`)
+
+    double electricPotential(double, const Point &) const = delete; //!< Not linear in the charges
+
     inline double operator()(const Particle &a, const Particle &b, const Point &r) const override {
         double r2 = r.squaredNorm();
         double r4inv = 1 / (r2 * r2);
@@ -563,6 +706,9 @@ class NewCoulombGalore : public PairPotentialBase {
     inline double operator()(const Particle &a, const Particle &b, const Point &r) const override {
         return lB * pot.ion_ion_energy(a.charge, b.charge, r.norm());
     }
+    inline double electricPotential(double charge, const Point &r) const {
+        return lB * pot.ion_ion_energy(1.0, charge, r.norm());
+    } //!< Potential (kT per unit charge) at distance `r` from `charge`
     Point force(const Particle &, const Particle &, double, const Point &) const override;
     void from_json(const json &) override;
     void to_json(json &) const override;
@@ -586,6 +732,7 @@ class Multipole : public NewCoulombGalore {
     }
 
     Point force(const Particle &, const Particle &, double, const Point &) const override;
+    double electricPotential(double, const Point &) const = delete; //!< Dipoles are not point charges
 };
 
 /**
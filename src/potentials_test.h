@@ -152,6 +152,75 @@ TEST_CASE("[Faunus] WeeksChandlerAndersen") {
     }
 }
 
+TEST_CASE("[Faunus] InversePowerSums") {
+    atoms = R"([{"A": {"sigma": 2.0, "eps": 0.9, "q": 1.0}},
+                {"B": {"sigma": 3.0, "eps": 0.5, "q": -1.0}}])"_json.get<decltype(atoms)>();
+    CombinedPairPotential<Coulomb, WeeksChandlerAndersen> pot;
+    pot.first.lB = 7.0;
+    pot.second = R"({"mixing": "LB"})"_json;
+
+    std::vector<Particle> p = {atoms[0], atoms[1], atoms[0], atoms[1]};
+    p[0].pos = {0, 0, 0};
+    p[1].pos = {2.7, 0, 0}; // A-B, just within cut-off of 2.5 * 2^(1/6) = 2.81
+    p[2].pos = {0, 3.0, 0}; // A-A, just beyond cut-off of 2.0 * 2^(1/6) = 2.24
+    p[3].pos = {0, 0, 6.0};
+
+    // energy with all separations scaled by `s`, optionally decomposed into `sums`
+    auto energy = [&](double s, InversePowerSums *pairs = nullptr) {
+        double u = 0;
+        for (size_t i = 0; i < p.size(); i++)
+            for (size_t j = i + 1; j < p.size(); j++) {
+                Point r = (p[i].pos - p[j].pos) * s;
+                u += pairs ? pot.decompose(p[i], p[j], r, *pairs) : pot(p[i], p[j], r);
+            }
+        return u;
+    };
+
+    InversePowerSums sums;
+    double u = energy(1.0, &sums);
+    CHECK(u == Approx(energy(1.0)));
+    CHECK(sums.energy() == Approx(u));
+
+    SUBCASE("energy") {
+        CHECK(sums.energy(1.02) == Approx(energy(1.02)));
+        CHECK(sums.energy(0.9) == Approx(energy(0.9)));
+        CHECK(std::isnan(sums.energy(1.05))); // A-B pair leaves the cut-off
+        CHECK(std::isnan(sums.energy(0.7)));  // A-A pair enters the cut-off
+    }
+
+    SUBCASE("scale") {
+        auto scaled = sums.scale(0.9);
+        CHECK(scaled.energy() == Approx(energy(0.9)));
+        CHECK(std::isnan(scaled.energy(0.7 / 0.9)));
+    }
+
+    SUBCASE("update") {
+        InversePowerSums removed, added;
+        auto pairsWith = [&](size_t k, InversePowerSums &pairs) {
+            for (size_t i = 0; i < p.size(); i++)
+                if (i != k)
+                    pot.decompose(p[i], p[k], p[i].pos - p[k].pos, pairs);
+        };
+        pairsWith(3, removed);
+        p[3].pos = {0, 0, 4.0};
+        pairsWith(3, added);
+        sums.update(removed, added);
+        CHECK(sums.energy() == Approx(energy(1.0)));
+        CHECK(sums.energy(1.02) == Approx(energy(1.02)));
+    }
+
+    SUBCASE("hard core") {
+        CombinedPairPotential<Coulomb, HardSphere> pm;
+        pm.first.lB = 7.0;
+        pm.second = R"({"mixing": "arithmetic"})"_json;
+        InversePowerSums hs;
+        Point r = {2.7, 0, 0}; // A-B contact distance is 2.5
+        pm.decompose(p[0], p[1], r, hs);
+        CHECK(hs.energy(0.95) == Approx(pm(p[0], p[1], r * 0.95)));
+        CHECK(std::isnan(hs.energy(0.9))); // overlap
+    }
+}
+
 TEST_CASE("[Faunus] HardSphere") {
     atoms = R"([{"A": {"sigma": 2}}, {"B": {"sigma": 8}}])"_json.get<decltype(atoms)>();
     Particle a = atoms[0], b = atoms[1];
@@ -356,6 +425,21 @@ TEST_CASE("[Faunus] Dipole-dipole interactions") {
     CHECK(u(a, b, r) == 0);
 }
 
+TEST_CASE("[Faunus] Electric potential") {
+    using doctest::Approx;
+    CombinedPairPotential<Coulomb, HardSphere> pm;
+    pm.first.lB = 7.0;
+    Particle a, b;
+    a.charge = 1.0;
+    b.charge = -2.0;
+    Point r = {0, 0, 4};
+    CHECK(has_electric_potential<decltype(pm)>::value);
+    CHECK(has_electric_potential<CombinedPairPotential<HardSphere, Coulomb>>::value);
+    CHECK(not has_electric_potential<CombinedPairPotential<Coulomb, Coulomb>>::value);
+    CHECK(not has_electric_potential<Polarizability>::value);
+    CHECK(a.charge * pm.electricPotential(b.charge, r) == Approx(pm.first(a, b, r)));
+}
+
 TEST_CASE("[Faunus] Pair Potentials") {
     json j = R"({ "atomlist" : [
                  { "A": { "r": 1.5, "tension": 0.023} },
@@ -371,8 +455,8 @@ TEST_CASE("[Faunus] Pair Potentials") {
         json in = R"({ "sasa": {"molarity": 1.0, "radius": 0.0, "shift":false}})"_json;
         pot = in["sasa"];
         double conc = 1.0 * 1.0_molar;
-        double tension = atoms[a.id].tension / 2;
-        double tfe = atoms[b.id].tfe / 2;
+        double tension = atoms[a.id].tension * 1.0_kJmol / 2;
+        double tfe = atoms[b.id].tfe * 1.0_kJmol / 1.0_molar / 2;
         double f = tension + conc * tfe;
         CHECK(tension > 0.0);
         CHECK(conc > 0.0);
@@ -382,6 +466,14 @@ TEST_CASE("[Faunus] Pair Potentials") {
         CHECK(pot(a, b, {0, 0, 0}) == Approx(f * 4 * pc::pi * 2.1 * 2.1));                // complete overlap
         CHECK(pot(a, b, {10, 0, 0}) == Approx(f * 4 * pc::pi * (2.1 * 2.1 + 1.5 * 1.5))); // far apart
         CHECK(pot(a, b, {2.5, 0, 0}) == Approx(f * 71.74894965974514));                   // partial overlap
+
+        // tension and tfe are converted to kT at the temperature of construction
+        auto temperature = pc::temperature;
+        pc::temperature = 2 * temperature;
+        SASApotential hot;
+        hot = in["sasa"];
+        pc::temperature = temperature;
+        CHECK(hot(a, b, {2.5, 0, 0}) == Approx(0.5 * pot(a, b, {2.5, 0, 0})));
     }
 }
 
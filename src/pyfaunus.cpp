@@ -217,7 +217,9 @@ PYBIND11_MODULE(pyfaunus, m)
         .def_readwrite("index", &Change::data::index)
         .def_readwrite("internal", &Change::data::internal)
         .def_readwrite("all", &Change::data::all)
-        .def_readwrite("atoms", &Change::data::atoms);
+        .def_property(
+            "atoms", [](const Change::data &d) { return std::vector<int>(d.atoms.begin(), d.atoms.end()); },
+            [](Change::data &d, const std::vector<int> &v) { d.atoms.assign(v.begin(), v.end()); });
 
     py::bind_vector<std::vector<Change::data>>(m, "ChangeDataVec");
 
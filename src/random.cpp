@@ -35,6 +35,13 @@ namespace Faunus {
 
     void Random::seed() { engine = std::mt19937(std::random_device()()); }
 
+    void Random::seed(const ParallelRandom &stream) {
+        std::array<Philox4x32::result_type, std::mt19937::state_size> bits;
+        ParallelRandom(stream).engine.generate(bits.begin(), bits.end());
+        std::seed_seq seq(bits.begin(), bits.end());
+        engine.seed(seq);
+    }
+
     Random::Random() : dist01(0,1) {}
 
     double Random::operator()() { return dist01(engine); }
@@ -44,5 +51,37 @@ namespace Faunus {
         return d(engine);
     }
 
-    Random random; // Global instance
+    ParallelRandom::ParallelRandom(uint64_t seed, uint64_t stream) : engine(seed, stream) {}
+
+    void ParallelRandom::seed() {
+        std::random_device rd;
+        engine.seed((uint64_t(rd()) << 32) | rd(), engine.stream());
+    }
+
+    ParallelRandom ParallelRandom::stream(uint64_t id) const { return ParallelRandom(engine.seed(), id); }
+
+    int ParallelRandom::range(int min, int max) {
+        std::uniform_int_distribution<int> d(min, max);
+        return d(engine);
+    }
+
+    void to_json(nlohmann::json &j, const ParallelRandom &r) {
+        j = {{"seed", r.engine.seed()}, {"stream", r.engine.stream()}, {"position", r.engine.position()}};
+    }
+
+    void from_json(const nlohmann::json &j, ParallelRandom &r) {
+        if (j.is_object()) {
+            auto seed = j.value("seed", nlohmann::json());
+            if (seed.is_string()) {
+                if (seed == "hardware")
+                    r.seed();
+                else if (seed != "default" and seed != "fixed")
+                    throw std::runtime_error("unknown seed: " + seed.get<std::string>());
+            } else if (seed.is_number())
+                r.engine.seed(seed.get<uint64_t>(), j.value("stream", r.engine.stream()));
+            r.engine.discard(j.value("position", uint64_t(0)));
+        }
+    }
+
+    thread_local Random random; // Global instance
 }
@@ -1,12 +1,17 @@
 #pragma once
 
 #include <random>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
 #include <vector>
 #include <cassert>
 #include <nlohmann/json_fwd.hpp>
 
 namespace Faunus {
 
+    struct ParallelRandom;
+
     /**
      * Example code:
      *
@@ -15,6 +20,7 @@ namespace Faunus {
      *     Random r2 = json(r1);                          // copy engine state
      *     Random r3 = R"( {"seed" : "hardware"} )"_json; // non-deterministic seed
      *     Random r1.seed();                              // non-deterministic seed
+     *     Random r4.seed(ParallelRandom().stream(4));    // deterministic seed from independent stream
      * ```
      */
     struct Random {
@@ -23,6 +29,7 @@ namespace Faunus {
 
         Random();
         void seed();
+        void seed(const ParallelRandom &); //!< Deterministic seed from the full state of a stream
         double operator()(); //!< Double in uniform range [0,1)
 
         /**
@@ -43,7 +50,7 @@ namespace Faunus {
     void to_json(nlohmann::json&, const Random&);   //!< Random to json conversion
     void from_json(const nlohmann::json&, Random&); //!< json to Random conversion
 
-    extern Random random; // global instance of Random
+    extern thread_local Random random; // global instance of Random (one per thread, see `Context`)
 
 #ifdef DOCTEST_LIBRARY_INCLUDED
     TEST_CASE("[Faunus] Random")
@@ -81,6 +88,207 @@ namespace Faunus {
     }
 #endif
 
+    /**
+     * @brief Counter-based Philox-4x32-10 random number engine
+     *
+     * Each block of four 32-bit numbers is a pure function of a key and a counter, see
+     * Salmon et al., [doi:10.1145/2063384.2063405](https://doi.org/10.1145/2063384.2063405).
+     * The key is the seed, and the upper half of the counter holds a stream id, giving
+     * 2^64 independent streams of 2^66 numbers each that are created at no cost.
+     * The complete state is given by seed, stream, and position and the engine
+     * satisfies `UniformRandomBitGenerator` for use with `std` distributions.
+     */
+    class Philox4x32 {
+      public:
+        typedef uint32_t result_type;
+
+      private:
+        uint64_t _seed, _stream;
+        uint64_t block;                     //!< Index of next block to generate
+        std::array<result_type, 4> buffer;  //!< Current block
+        unsigned int index;                 //!< Next element in buffer (4 = empty)
+
+        static inline void round(std::array<result_type, 4> &ctr, const std::array<result_type, 2> &key) {
+            uint64_t p0 = uint64_t(0xD2511F53) * ctr[0];
+            uint64_t p1 = uint64_t(0xCD9E8D57) * ctr[2];
+            ctr = {result_type(p1 >> 32) ^ ctr[1] ^ key[0], result_type(p1), result_type(p0 >> 32) ^ ctr[3] ^ key[1],
+                   result_type(p0)};
+        }
+
+      public:
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return 0xFFFFFFFF; }
+
+        explicit Philox4x32(uint64_t seed = 0, uint64_t stream = 0) { this->seed(seed, stream); }
+
+        void seed(uint64_t seed, uint64_t stream = 0) {
+            _seed = seed;
+            _stream = stream;
+            block = 0;
+            index = 4;
+        } //!< Set key and stream; restarts at position zero
+
+        uint64_t seed() const { return _seed; }
+        uint64_t stream() const { return _stream; }
+        uint64_t position() const { return 4 * block - (4 - index); } //!< Number of values drawn so far
+
+        /** @brief The block with counter `(n, stream)` */
+        std::array<result_type, 4> operator[](uint64_t n) const {
+            std::array<result_type, 4> ctr = {result_type(n), result_type(n >> 32), result_type(_stream),
+                                              result_type(_stream >> 32)};
+            std::array<result_type, 2> key = {result_type(_seed), result_type(_seed >> 32)};
+            for (int i = 0; i < 9; i++) {
+                round(ctr, key);
+                key[0] += 0x9E3779B9;
+                key[1] += 0xBB67AE85;
+            }
+            round(ctr, key);
+            return ctr;
+        }
+
+        result_type operator()() {
+            if (index == 4) {
+                buffer = (*this)[block++];
+                index = 0;
+            }
+            return buffer[index++];
+        }
+
+        void discard(uint64_t n) {
+            uint64_t pos = position() + n;
+            block = pos / 4;
+            index = 4;
+            for (unsigned int i = 0; i < pos % 4; i++)
+                operator()();
+        } //!< Skip `n` values in constant time
+
+        /**
+         * @brief Fill range with random numbers
+         *
+         * Equivalent to, but faster than, repeated calls to `operator()` as
+         * whole blocks are written directly without intermediate buffering.
+         */
+        template <class Titer> void generate(Titer begin, Titer end) {
+            while (begin != end and index != 4)
+                *begin++ = operator()();
+            while (std::distance(begin, end) >= 4) {
+                auto ctr = (*this)[block++];
+                begin = std::copy(ctr.begin(), ctr.end(), begin);
+            }
+            while (begin != end)
+                *begin++ = operator()();
+        }
+
+        bool operator==(const Philox4x32 &other) const {
+            return _seed == other._seed and _stream == other._stream and position() == other.position();
+        }
+    };
+
+    /**
+     * @brief Random number generator with independent, reproducible streams
+     *
+     * This has the same interface as `Random`, but is based on a counter-based engine
+     * so that independent streams, i.e. for threads or replicas, are cheap to create
+     * and reproducible regardless of how work is distributed. The state
+     * serializes to json as seed, stream and position.
+     *
+     * ```{.cpp}
+     *     ParallelRandom r(1234);                        // seed (stream 0)
+     *     auto r2 = r.stream(omp_get_thread_num());      // independent stream
+     *     std::vector<double> v(1000);
+     *     r2.generate(v.begin(), v.end());               // bulk uniform [0,1)
+     * ```
+     */
+    struct ParallelRandom {
+        Philox4x32 engine; //!< Random number engine used for all operations
+
+        ParallelRandom(uint64_t seed = 0, uint64_t stream = 0);
+        void seed(); //!< Non-deterministic seed; keeps stream
+        ParallelRandom stream(uint64_t id) const; //!< New independent stream with same seed
+
+        double operator()() {
+            auto a = engine(); // argument evaluation order is unspecified
+            return canonical(a, engine());
+        } //!< Double in uniform range [0,1)
+
+        /**
+         * @brief Integer in uniform range [min:max]
+         * @param min minimum value
+         * @param max maximum value
+         * @return random value in [min:max] range
+         */
+        int range(int, int);
+
+        template <class Titer> Titer sample(Titer begin, Titer end) {
+            std::advance(begin, range(0, std::distance(begin, end) - 1));
+            return begin;
+        } //!< Iterator to random element in container (std::vector, std::map, etc)
+
+        /**
+         * @brief Fill range with doubles in uniform range [0,1)
+         *
+         * The values are identical to those from repeated calls to `operator()`.
+         */
+        template <class Titer> void generate(Titer begin, Titer end) {
+            std::vector<Philox4x32::result_type> bits(2 * std::distance(begin, end));
+            engine.generate(bits.begin(), bits.end());
+            for (size_t i = 0; i < bits.size(); i += 2)
+                *begin++ = canonical(bits[i], bits[i + 1]);
+        }
+
+      private:
+        static inline double canonical(uint32_t a, uint32_t b) {
+            return ((a >> 5) * 67108864.0 + (b >> 6)) * (1.0 / 9007199254740992.0);
+        } //!< 53-bit double in [0,1) from two 32-bit integers
+    };
+
+    void to_json(nlohmann::json &, const ParallelRandom &);   //!< ParallelRandom to json conversion
+    void from_json(const nlohmann::json &, ParallelRandom &); //!< json to ParallelRandom conversion
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+    TEST_CASE("[Faunus] ParallelRandom") {
+        // known answers from the Random123 distribution
+        Philox4x32 philox;
+        CHECK(philox[0] == std::array<uint32_t, 4>({0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+        philox.seed(0xFFFFFFFFFFFFFFFF, 0xFFFFFFFFFFFFFFFF);
+        CHECK(philox[0xFFFFFFFFFFFFFFFF] == std::array<uint32_t, 4>({0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+
+        ParallelRandom a(10), b(10);
+        CHECK(a() == b());
+        CHECK(a.stream(1)() != a.stream(2)());
+        CHECK(a.stream(1)() == b.stream(1)());
+
+        // bulk generation and skipping ahead reproduce serial draws
+        std::vector<double> v(11);
+        b.generate(v.begin(), v.end());
+        for (auto x : v)
+            CHECK(x == a());
+        a.engine.discard(9);
+        b.engine.discard(3);
+        b.engine.discard(6);
+        CHECK(a() == b());
+
+        double sum = 0;
+        int N = 1e5;
+        for (int i = 0; i < N; i++)
+            sum += a.range(0, 9);
+        CHECK(sum / N == doctest::Approx(4.5).epsilon(0.01));
+
+        ParallelRandom c = nlohmann::json(a); // a --> json --> c
+        CHECK(c.engine == a.engine);
+        CHECK(c() == a());
+
+        // Mersenne twisters seeded from streams
+        Random r1, r2, r3;
+        r1.seed(a.stream(1));
+        r2.seed(b.stream(1));
+        r3.seed(a.stream(2));
+        CHECK(r1() == r2());
+        CHECK(r1() != r3());
+        CHECK(r1() != Random()());
+    }
+#endif
+
     /**
      * @brief Stores a series of elements with given weight
      *
@@ -1,6 +1,11 @@
 #pragma once
 
 #include <fstream>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <algorithm>
+#include <complex>
 
 namespace Faunus {
 
@@ -54,8 +59,10 @@ namespace Faunus {
          *
          * - `qmin` Minimum q value (1/angstrom)
          * - `qmax` Maximum q value (1/angstrom)
-         * - `dr` q spacing (1/angstrom)
+         * - `dq` q spacing (1/angstrom)
          * - `cutoff` Cutoff distance (angstrom). *Experimental!*
+         * - `method` Either `histogram` (default) or `direct`, see `sampleHistogram()`
+         * - `dr` Radial bin width for the histogram method (default: 0.01 angstrom)
          *
          * See also <http://dx.doi.org/10.1016/S0022-2860(96)09302-7>
          */
@@ -63,6 +70,69 @@ namespace Faunus {
             class DebyeFormula {
                 private:
                     T qmin, qmax, dq, rc;
+                    T dr;           // radial bin width for the histogram method
+                    bool histogram; // sample using a pair distance histogram?
+
+                    /**
+                     * @brief Call `f(local, i, j, r2)` for all pairs, `i<j`, closer than the cut-off
+                     *
+                     * The outer loop is OpenMP parallel and each thread works on its own copy,
+                     * `local`, of `init` which is finally passed to `merge()` one thread at a
+                     * time. If a cut-off is given, points are binned into cubic cells of the
+                     * cut-off size so that only neighbouring cells are visited. The cell list
+                     * assumes non-periodic distances as used for scattering.
+                     */
+                    template<class Tpvec, class Tlocal, class Tfunction, class Tmerge>
+                        void forEachPair( const Tpvec &p, const Tlocal &init, Tfunction f, Tmerge merge ) {
+                            const int N = (int) p.size();
+                            const bool celllist = (rc < 1e9 && N > 0);
+                            Point low(0, 0, 0), high(0, 0, 0);
+                            Eigen::Vector3i cells(1, 1, 1);
+                            std::vector<std::vector<int>> members; // point indices in each cell
+                            auto cellIndex = [&]( const Eigen::Vector3i &c ) { return (c.x() * cells.y() + c.y()) * cells.z() + c.z(); };
+                            auto cellOf = [&]( const Point &a ) -> Eigen::Vector3i { return ((a - low) / rc).array().floor().template cast<int>(); };
+                            if ( celllist ) {
+                                low = high = p[0];
+                                for ( auto &i : p ) {
+                                    low = low.cwiseMin(i);
+                                    high = high.cwiseMax(i);
+                                }
+                                cells = cellOf(high) + Eigen::Vector3i::Ones();
+                                members.resize(cells.prod());
+                                for ( int i = 0; i < N; i++ )
+                                    members[cellIndex(cellOf(p[i]))].push_back(i);
+                            }
+#pragma omp parallel
+                            {
+                                Tlocal local = init;
+                                if ( celllist ) {
+#pragma omp for schedule(dynamic, 16)
+                                    for ( int i = 0; i < N; i++ ) {
+                                        Eigen::Vector3i c = cellOf(p[i]), d;
+                                        for ( d.x() = std::max(c.x() - 1, 0); d.x() <= std::min(c.x() + 1, cells.x() - 1); d.x()++ )
+                                            for ( d.y() = std::max(c.y() - 1, 0); d.y() <= std::min(c.y() + 1, cells.y() - 1); d.y()++ )
+                                                for ( d.z() = std::max(c.z() - 1, 0); d.z() <= std::min(c.z() + 1, cells.z() - 1); d.z()++ )
+                                                    for ( int j : members[cellIndex(d)] )
+                                                        if ( j > i ) {
+                                                            T r2 = geo.sqdist(p[i], p[j]);
+                                                            if ( r2 < rc * rc )
+                                                                f(local, i, j, r2);
+                                                        }
+                                    }
+                                } else {
+                                    std::vector<double> r2(N); // squared distances to all following points
+#pragma omp for schedule(dynamic, 16)
+                                    for ( int i = 0; i < N - 1; ++i ) {
+                                        geo.batchSqdist(p[i], &p[i + 1], N - i - 1, r2.data());
+                                        for ( int j = i + 1; j < N; ++j )
+                                            f(local, i, j, T(r2[j - i - 1]));
+                                    }
+                                }
+#pragma omp critical
+                                merge(local);
+                            }
+                        }
+
                 protected:
                     Tformfactor F; // scattering from a single particle
                     Tgeometry geo; // geometry to use for distance calculations
@@ -76,9 +146,17 @@ namespace Faunus {
                         qmin = j.at("qmin").get<double>();
                         qmax = j.at("qmax").get<double>();
                         rc = j.value("cutoff", 1.0e9);
+                        dr = j.value("dr", 0.01);
+
+                        std::string method = j.value("method", "histogram");
+                        if (method != "histogram" && method != "direct")
+                            throw std::runtime_error("DebyeFormula: method must be 'histogram' or 'direct'");
+                        histogram = (method == "histogram");
 
                         if (dq<=0 || qmin<=0 || qmax<=0 || qmin>qmax)
                             throw std::runtime_error("DebyeFormula: invalid q parameters");
+                        if (dr<=0)
+                            throw std::runtime_error("DebyeFormula: invalid dr");
                     }
 
                     /**
@@ -112,6 +190,8 @@ namespace Faunus {
                         void sample( const Tpvec &p, T qmin, T qmax, T dq, T f = 1, T V = -1 ) {
                             if ( qmin < 1e-6 )
                                 qmin = dq;              // ensure that q>0
+                            if ( histogram )
+                                return sampleHistogram(p, qmin, qmax, dq, f, V);
 
                             // Temporary f(q) functions - initialized to
                             // enable O(N) complexity iteration in inner loop.
@@ -151,6 +231,94 @@ namespace Faunus {
                             }
                         }
 
+                    /**
+                     * @brief Sample I(q) via a histogram of pair distances
+                     *
+                     * Points with identical form factors over the q range share a class
+                     * and pair distances are binned per pair of classes with a bin width of
+                     * `dr`. The Debye formula is then evaluated once per non-empty bin
+                     * using the bin center, reducing the complexity from O(N^2 Nq) to
+                     * O(N^2 + Nbins Nq). The discretisation error in `qr` is at most `q dr/2`.
+                     */
+                    template<class Tpvec>
+                        void sampleHistogram( const Tpvec &p, T qmin, T qmax, T dq, T f = 1, T V = -1 ) {
+                            std::vector<T> q;
+                            for ( T x = qmin; x <= qmax; x += dq )
+                                q.push_back(x);
+                            const int N = (int) p.size(), Nq = (int) q.size();
+
+                            // form factor classes
+                            std::map<std::vector<T>, int> classes;
+                            std::vector<std::vector<T>> F_class; // F(q) for each class
+                            std::vector<int> cls(N), count;      // class of each point; points per class
+                            for ( int i = 0; i < N; i++ ) {
+                                std::vector<T> ff(Nq);
+                                for ( int k = 0; k < Nq; k++ )
+                                    ff[k] = F(q[k], p[i]);
+                                auto it = classes.emplace(ff, int(F_class.size()));
+                                if ( it.second ) {
+                                    F_class.push_back(ff);
+                                    count.push_back(0);
+                                }
+                                cls[i] = it.first->second;
+                                count[cls[i]]++;
+                            }
+                            const int C = (int) F_class.size();
+
+                            // histogram of pair distances for each pair of classes
+                            T rmax = rc;
+                            if ( rc >= 1e9 && N > 0 ) {
+                                Point low = p[0], high = p[0];
+                                for ( auto &i : p ) {
+                                    low = low.cwiseMin(i);
+                                    high = high.cwiseMax(i);
+                                }
+                                rmax = (high - low).norm();
+                            }
+                            const int bins = int(rmax / dr) + 1;
+                            std::vector<double> hist(C * C * bins, 0.0);
+                            forEachPair(p, hist,
+                                    [&]( std::vector<double> &local, int i, int j, T r2 ) {
+                                        int c1 = std::min(cls[i], cls[j]), c2 = std::max(cls[i], cls[j]);
+                                        int bin = std::min(int(std::sqrt(r2) / dr), bins - 1);
+                                        local[(c1 * C + c2) * bins + bin] += 1;
+                                    },
+                                    [&]( const std::vector<double> &local ) {
+                                        for ( size_t k = 0; k < hist.size(); k++ )
+                                            hist[k] += local[k];
+                                    });
+
+                            // Debye transform of each non-empty bin
+                            std::vector<double> _I(Nq, 0.0), _ff(Nq, 0.0);
+                            for ( int c1 = 0; c1 < C; c1++ ) {
+                                for ( int k = 0; k < Nq; k++ )
+                                    _ff[k] += count[c1] * F_class[c1][k] * F_class[c1][k];
+                                for ( int c2 = c1; c2 < C; c2++ ) {
+                                    const double *h = &hist[(c1 * C + c2) * bins];
+#pragma omp parallel for schedule(static)
+                                    for ( int k = 0; k < Nq; k++ ) {
+                                        double sum = 0;
+                                        for ( int bin = 0; bin < bins; bin++ )
+                                            if ( h[bin] > 0 ) {
+                                                double qr = q[k] * (bin + 0.5) * dr;
+                                                sum += h[bin] * std::sin(qr) / qr;
+                                            }
+                                        _I[k] += F_class[c1][k] * F_class[c2][k] * sum;
+                                    }
+                                }
+                            }
+
+                            for ( int k = 0; k < Nq; k++ )
+                            {
+                                T Icorr = 0;
+                                if ( rc < 1e9 && V > 0 )
+                                    Icorr = 4 * pc::pi * N / (V * pow(q[k], 3)) *
+                                        (q[k] * rc * cos(q[k] * rc) - sin(q[k] * rc));
+                                S[q[k]] += f;
+                                I[q[k]] += ((2 * _I[k] + _ff[k]) / N + Icorr) * f; // add to average I(q)
+                            }
+                        }
+
                     /**
                      * @brief Sample between all groups
                      *
@@ -373,5 +541,223 @@ namespace Faunus {
                         }
             };
 
+        /**
+         * @brief Structure factor from explicit, periodic q vectors
+         *
+         * @f[
+         *   S(\mathbf{q}) = \frac{1}{N} \left < \left | \sum_j^N
+         *   \exp(i\mathbf{qr}_j) \right |^2 \right >
+         * @f]
+         *
+         * is sampled for q vectors commensurate with a cuboidal box of side lengths
+         * @f$\mathbf{L}@f$, i.e. @f$\mathbf{q} = 2\pi p \mathbf{n}/\mathbf{L}@f$ with
+         * @f$p=1,\dots,p_{max}@f$ along the directions @f$\mathbf{n}@f$ of the
+         * Cartesian axes, face diagonals and body diagonals. As for the Ewald k-vectors,
+         * only a single complex exponential is evaluated for each point and direction;
+         * higher multiples follow from the recurrence
+         * @f$ e^{ip\theta} = e^{i(p-1)\theta} e^{i\theta} @f$.
+         *
+         * The density modes, @f$\rho(\mathbf{q})@f$, are kept between samples so that
+         * `update()` needs only visit points that moved since last time. The full
+         * evaluation is OpenMP parallel over blocks of points.
+         * Results are averaged over directions with the same @f$|\mathbf{q}|@f$.
+         */
+        template<class T=double>
+            class StructureFactorPBC {
+                private:
+                    typedef std::complex<T> Tcomplex;
+                    std::vector<Point> directions = {
+                        {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 1, 0}, {0, 1, 1}, {1, 0, 1}, {-1, 1, 0},
+                        {0, -1, 1}, {1, 0, -1}, {1, 1, 1}, {-1, 1, 1}, {1, -1, 1}, {1, 1, -1}};
+                    int pmax;                     // number of multiples of each direction
+                    Point box = {0, 0, 0};        // box side lengths for current q vectors
+                    std::vector<Tcomplex> rho;    // density modes, directions x pmax
+                    std::vector<Point> positions; // points that make up `rho`
+
+                    // add `sign` times the Fourier terms of point `r` along direction `d` to `modes`
+                    void addModes( size_t d, const Point &r, T sign, Tcomplex *modes ) const {
+                        T theta = 2 * pc::pi * directions[d].cwiseQuotient(box).dot(r);
+                        Tcomplex eiqr(std::cos(theta), std::sin(theta)), e = sign * eiqr;
+                        for ( int p = 0; p < pmax; p++ ) {
+                            modes[d * pmax + p] += e;
+                            e *= eiqr;
+                        }
+                    }
+
+                public:
+                    std::map<T, T> I; //!< Sampled, average S(q)
+                    std::map<T, T> S; //!< Weighted number of samplings
+
+                    StructureFactorPBC( int pmax = 15 ) : pmax(pmax) {
+                        if ( pmax < 1 )
+                            throw std::runtime_error("StructureFactorPBC: pmax must be positive");
+                        rho.resize(directions.size() * pmax);
+                    }
+
+                    /**
+                     * @brief Evaluate all density modes from scratch
+                     * @param p Positions
+                     * @param L Box side lengths
+                     */
+                    template<class Tpositions>
+                        void compute( const Tpositions &p, const Point &L ) {
+                            box = L;
+                            positions.assign(p.begin(), p.end());
+                            std::fill(rho.begin(), rho.end(), Tcomplex(0, 0));
+                            const int N = (int) positions.size();
+#pragma omp parallel
+                            {
+                                std::vector<Tcomplex> local(rho.size(), Tcomplex(0, 0));
+#pragma omp for schedule(static)
+                                for ( int i = 0; i < N; i++ )
+                                    for ( size_t d = 0; d < directions.size(); d++ )
+                                        addModes(d, positions[i], 1, local.data());
+#pragma omp critical
+                                for ( size_t k = 0; k < rho.size(); k++ )
+                                    rho[k] += local[k];
+                            }
+                        }
+
+                    /**
+                     * @brief Update density modes for the given points only
+                     *
+                     * The old contribution of each point is subtracted and the new one
+                     * added. This is O(M) in the number of moved points, M, and
+                     * parallel over directions if M is large.
+                     *
+                     * @param p Positions with the same size and ordering as in the last call
+                     * @param moved Indices of points in `p` that may have moved
+                     */
+                    template<class Tpositions, class Tindices>
+                        void update( const Tpositions &p, const Tindices &moved ) {
+                            assert(p.size() == positions.size());
+                            const int D = (int) directions.size();
+#pragma omp parallel for schedule(static) if (moved.size() > 64)
+                            for ( int d = 0; d < D; d++ )
+                                for ( int i : moved ) {
+                                    addModes(d, positions[i], -1, rho.data());
+                                    addModes(d, p[i], 1, rho.data());
+                                }
+                            for ( int i : moved )
+                                positions[i] = p[i];
+                        }
+
+                    /**
+                     * @brief Bring density modes up to date with `p`
+                     *
+                     * Points that differ from the last call are detected and handed to
+                     * `update()`. All modes are re-evaluated if the box or the number of
+                     * points changed, or if more than half of the points moved.
+                     */
+                    template<class Tpositions>
+                        void sync( const Tpositions &p, const Point &L ) {
+                            if ( L != box || p.size() != positions.size() )
+                                return compute(p, L);
+                            std::vector<int> moved;
+                            for ( size_t i = 0; i < positions.size(); i++ )
+                                if ( positions[i] != p[i] )
+                                    moved.push_back((int) i);
+                            if ( 2 * moved.size() > positions.size() )
+                                compute(p, L);
+                            else if ( !moved.empty() )
+                                update(p, moved);
+                        }
+
+                    /**
+                     * @brief Add current density modes to the average S(q)
+                     */
+                    void sample( T f = 1 ) {
+                        if ( positions.empty() )
+                            return;
+                        for ( size_t d = 0; d < directions.size(); d++ ) {
+                            T qnorm = 2 * pc::pi * directions[d].cwiseQuotient(box).norm();
+                            for ( int p = 0; p < pmax; p++ ) {
+                                T q = (p + 1) * qnorm;
+                                S[q] += f;
+                                I[q] += std::norm(rho[d * pmax + p]) / positions.size() * f;
+                            }
+                        }
+                    }
+
+                    /**
+                     * @brief Update density modes and sample S(q)
+                     * @param p Positions
+                     * @param L Box side lengths
+                     * @param f Weight of sampled configuration
+                     */
+                    template<class Tpositions>
+                        void sample( const Tpositions &p, const Point &L, T f = 1 ) {
+                            sync(p, L);
+                            sample(f);
+                        }
+
+                    /**
+                     * @brief Save S(q) to disk
+                     */
+                    void save( const std::string &filename ) const {
+                        if ( !I.empty() ) {
+                            std::ofstream f(filename.c_str());
+                            if ( f )
+                                for ( auto &i : I )
+                                    f << i.first << " " << i.second / S.at(i.first) << "\n";
+                        }
+                    }
+            };
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+        TEST_CASE("[Faunus] DebyeFormula")
+        {
+            Random r;
+            std::vector<Point> p(200);
+            for ( auto &i : p )
+                i = Point(r(), r(), r()) * 40;
+            for ( double rc : {1.0e9, 15.0} ) {
+                json j = {{"qmin", 0.05}, {"qmax", 1.0}, {"dq", 0.05}, {"cutoff", rc}, {"method", "direct"}};
+                DebyeFormula<FormFactorUnity<double>> direct(j);
+                j["method"] = "histogram";
+                DebyeFormula<FormFactorUnity<double>> histogram(j);
+                direct.sample(p, 1, 64000);
+                histogram.sample(p, 1, 64000);
+                CHECK(direct.I.size() == histogram.I.size());
+                for ( auto &i : direct.I )
+                    CHECK(histogram.I.at(i.first) == doctest::Approx(i.second).epsilon(1e-3));
+            }
+            CHECK_THROWS(DebyeFormula<FormFactorUnity<double>>(
+                        json({{"qmin", 0.1}, {"qmax", 1.0}, {"dq", 0.1}, {"method", "fast"}})));
+        }
+
+        TEST_CASE("[Faunus] StructureFactorPBC")
+        {
+            using doctest::Approx;
+            Random r;
+            Point L(20, 25, 30);
+            std::vector<Point> p(100);
+            for ( auto &i : p )
+                i = Point(r(), r(), r()).cwiseProduct(L);
+
+            StructureFactorPBC<double> incremental(5), full(5);
+            incremental.compute(p, L);
+            p[3] += Point(1, -2, 0.5); // move a few points
+            p[42] = Point(r(), r(), r()).cwiseProduct(L);
+            incremental.sample(p, L);
+            full.compute(p, L);
+            full.sample();
+            CHECK(incremental.I.size() == full.I.size());
+            for ( auto &i : full.I )
+                CHECK(incremental.I.at(i.first) == Approx(i.second));
+
+            // brute force S(q) along x for p=1
+            double q = 2 * pc::pi / L.x(), c = 0, s = 0;
+            for ( auto &i : p ) {
+                c += std::cos(q * i.x());
+                s += std::sin(q * i.x());
+            }
+            StructureFactorPBC<double> x(1);
+            x.compute(p, L);
+            x.sample();
+            CHECK(x.I.at(q) / x.S.at(q) == Approx((c * c + s * s) / p.size()));
+        }
+#endif
+
     } // end of namespace
 } //end of namespace
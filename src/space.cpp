@@ -14,6 +14,7 @@ void Change::clear() {
     all = false;
     dN = false;
     moved2moved = true;
+    chargeMove = false;
     groups.clear();
     assert(empty());
 }
@@ -26,6 +27,11 @@ bool Change::empty() const {
     return false;
 }
 Change::operator bool() const { return not empty(); }
+void Change::touchedGroupIndex(std::vector<int> &index) const {
+    index.clear();
+    for (auto &d : groups)
+        index.push_back(d.index);
+}
 
 void Space::clear() {
     p.clear();
@@ -97,53 +103,72 @@ void Space::sync(Space &other, const Change &change) {
 }
 
 void Space::scaleVolume(double Vnew, Geometry::VolumeMethod method) {
-    for (auto &g : groups) // remove periodic boundaries
-        if (not g.atomic)
-            g.unwrap(geo.getDistanceFunc());
+    const bool parallel = p.size() > 10000; // below this, thread overhead exceeds the work
+    auto vdist = [&geo = geo](const Point &a, const Point &b) { return geo.vdist(a, b); };
+
+#pragma omp parallel for schedule(dynamic) if (parallel)
+    for (size_t k = 0; k < groups.size(); k++) // remove periodic boundaries
+        if (not groups[k].atomic)
+            groups[k].unwrap(vdist);
 
     Point scale = geo.setVolume(Vnew, method);
 
+    // atomic groups are scaled in chunks of contiguous positions to use the batched boundary
+    constexpr int chunk = 256;
     for (auto &g : groups) {
-        if (not g.empty()) {
-            if (g.atomic) { // scale all atoms
+        if (g.atomic and not g.empty()) {
+            const int size = g.size();
+            const auto first = g.begin();
+#pragma omp parallel for schedule(static) if (parallel)
+            for (int offset = 0; offset < size; offset += chunk) {
+                std::array<Point, chunk> positions;
+                const int n = std::min(chunk, size - offset);
+                for (int i = 0; i < n; i++)
+                    positions[i] = (first + offset + i)->pos.cwiseProduct(scale);
+                geo.batchBoundary(positions.data(), n);
+                for (int i = 0; i < n; i++)
+                    (first + offset + i)->pos = positions[i];
+            }
+        }
+    }
+
+    // molecular groups are independent and scaled in parallel
+#pragma omp parallel for schedule(dynamic) if (parallel)
+    for (size_t k = 0; k < groups.size(); k++) {
+        auto &g = groups[k];
+        if (not g.empty() and not g.atomic) { // scale mass center and translate
+            Point oldcm = g.cm;
+            if (g.compressible) {
                 for (auto &i : g) {
                     i.pos = i.pos.cwiseProduct(scale);
                     geo.boundary(i.pos);
                 }
-            } else { // scale mass center and translate
-                Point oldcm = g.cm;
-                if (g.compressible) {
-                    for (auto &i : g) {
-                        i.pos = i.pos.cwiseProduct(scale);
-                        geo.boundary(i.pos);
-                    }
-                    g.cm = Geometry::massCenter(g.begin(), g.end(), geo.getBoundaryFunc(), -oldcm);
-                    geo.boundary(g.cm);
-                } else {
-                    g.cm = g.cm.cwiseProduct(scale);
-                    geo.boundary(g.cm);
-                    Point delta = g.cm - oldcm;
-                    for (auto &i : g) {
-                        i.pos += delta;
-                        geo.boundary(i.pos);
-                    }
+                g.cm = Geometry::massCenter(g.begin(), g.end(), geo.getBoundaryFunc(), -oldcm);
+                geo.boundary(g.cm);
+            } else {
+                g.cm = g.cm.cwiseProduct(scale);
+                geo.boundary(g.cm);
+                Point delta = g.cm - oldcm;
+                for (auto &i : g) {
+                    i.pos += delta;
+                    geo.boundary(i.pos);
+                }
 #ifndef NDEBUG
-                    Point recalc_cm = Geometry::massCenter(g.begin(), g.end(), geo.getBoundaryFunc(), -g.cm);
-                    double cm_error = std::fabs(geo.sqdist(g.cm, recalc_cm));
-                    if (cm_error > 1e-6) {
-                        std::ostringstream o;
-                               o  << "error: " << cm_error << std::endl
-                                  << "scale: " << scale.transpose() << std::endl
-                                  << "delta: " << delta.transpose() << " norm = " << delta.norm() << std::endl
-                                  << "|o-n|: " << geo.vdist(oldcm, g.cm).norm() << std::endl
-                                  << "oldcm: " << oldcm.transpose() << std::endl
-                                  << "newcm: " << g.cm.transpose() << std::endl
-                                  << "actual cm: " << recalc_cm.transpose() << std::endl;
-                        faunus_logger->error(o.str());
-                        assert(false);
-                    }
-#endif
+                Point recalc_cm = Geometry::massCenter(g.begin(), g.end(), geo.getBoundaryFunc(), -g.cm);
+                double cm_error = std::fabs(geo.sqdist(g.cm, recalc_cm));
+                if (cm_error > 1e-6) {
+                    std::ostringstream o;
+                           o  << "error: " << cm_error << std::endl
+                              << "scale: " << scale.transpose() << std::endl
+                              << "delta: " << delta.transpose() << " norm = " << delta.norm() << std::endl
+                              << "|o-n|: " << geo.vdist(oldcm, g.cm).norm() << std::endl
+                              << "oldcm: " << oldcm.transpose() << std::endl
+                              << "newcm: " << g.cm.transpose() << std::endl
+                              << "actual cm: " << recalc_cm.transpose() << std::endl;
+                    faunus_logger->error(o.str());
+                    assert(false);
                 }
+#endif
             }
         }
     }
@@ -152,8 +177,9 @@ void Space::scaleVolume(double Vnew, Geometry::VolumeMethod method) {
     if (method == Geometry::ISOCHORIC)
         Vold = std::pow(Vold, 1. / 3.);
 
-    for (auto f : scaleVolumeTriggers)
-        f(*this, Vold, Vnew);
+#pragma omp parallel for schedule(dynamic) if (scaleVolumeTriggers.size() > 1)
+    for (size_t k = 0; k < scaleVolumeTriggers.size(); k++)
+        scaleVolumeTriggers[k](*this, Vold, Vnew);
 }
 
 json Space::info() {
@@ -3,6 +3,7 @@
 #include "geometry.h"
 #include "group.h"
 #include "molecule.h"
+#include "auxiliary.h"
 
 namespace Faunus {
 
@@ -23,7 +24,9 @@ struct Change {
     bool all = false;        //!< Set to true if *everything* has changed
     bool dN = false;         //!< True if the number of atomic or molecular species has changed
     bool moved2moved = true; //!< If several groups are moved, should they interact with each other?
-    bool chargeMove = false;
+    bool chargeMove = false; //!< True if only charges, not positions, of the touched atoms have changed
+
+    typedef SmallVector<int, 8> Tindex; //!< Atom index list; inline storage avoids allocation for small changes
 
     struct data {
         bool dNatomic = false;  //!< True if the number of atomic molecules has changed
@@ -31,16 +34,14 @@ struct Change {
         int index;              //!< Touched group index
         bool internal = false;  //!< True if the internal energy/config has changed
         bool all = false;       //!< True if all particles in group have been updated
-        std::vector<int> atoms; //!< Touched atom index w. respect to `Group::begin()`
+        Tindex atoms;           //!< Touched atom index w. respect to `Group::begin()`
 
         bool operator<(const data &a) const;
     }; //!< Properties of changed groups
 
     std::vector<data> groups; //!< Touched groups by index in group vector
 
-    inline auto touchedGroupIndex() {
-        return ranges::view::transform(groups, [](data &i) -> int { return i.index; });
-    } //!< List of moved groups (index)
+    void touchedGroupIndex(std::vector<int> &index) const; //!< Fill `index` with moved groups, reusing its storage
 
     void clear();       //!< Clear all change data
     bool empty() const; //!< Check if change object is empty
@@ -69,7 +70,7 @@ struct Space {
     typedef std::function<void(Space &, const Tchange &)> ChangeTrigger;
     typedef std::function<void(Space &, const Space &, const Tchange &)> SyncTrigger;
 
-    std::vector<ScaleVolumeTrigger> scaleVolumeTriggers; //!< Call when volume is scaled
+    std::vector<ScaleVolumeTrigger> scaleVolumeTriggers; //!< Call when volume is scaled (possibly concurrently)
     std::vector<ChangeTrigger> changeTriggers;           //!< Call when a Change object is applied
     std::vector<SyncTrigger> onSyncTriggers;             //!< Call when two Space objects are synched
 
@@ -193,6 +194,10 @@ struct Space {
      * - positions of free atoms
      * - positions of molecular masscenters
      * - simulation container
+     *
+     * Groups are processed in parallel using OpenMP for large systems and
+     * `scaleVolumeTriggers` may be called concurrently, i.e. triggers must
+     * not modify shared state.
      */
     void scaleVolume(double Vnew, Geometry::VolumeMethod method = Geometry::ISOTROPIC); //!< scale space to new volume
 
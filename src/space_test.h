@@ -1,4 +1,5 @@
 #include "space.h"
+#include "io.h"
 
 namespace Faunus {
 
@@ -11,6 +12,14 @@ TEST_CASE("[Faunus] Change") {
     change.dV = true;
     CHECK(not change.empty());
     CHECK(change);
+
+    std::vector<int> index(10, -1);
+    change.groups.resize(2);
+    change.groups[0].index = 3;
+    change.groups[1].index = 7;
+    change.touchedGroupIndex(index);
+    CHECK(index == std::vector<int>({3, 7}));
+    CHECK(index.capacity() >= 10); // storage is reused
 }
 
 TEST_CASE("[Faunus] Space") {
@@ -114,5 +123,117 @@ TEST_CASE("[Faunus] Space") {
     }
 }
 
+TEST_CASE("[Faunus] FormatCheckpoint") {
+    Tspace spc1, spc2;
+    spc1.geo = R"( {"type": "cuboid", "length": [10, 20, 30]} )"_json;
+    atoms.resize(2);
+    Particle a;
+    a.id = 1;
+    a.charge = -0.5;
+    a.pos = {1, 2, 3};
+    Tspace::Tpvec p(3, a);
+    p[1].pos.x() = -4;
+    spc1.push_back(0, p);
+    spc1.push_back(0, p);
+    spc1.groups[1].deactivate(spc1.groups[1].end() - 1, spc1.groups[1].end());
+    spc1.groups[1].confid = 2;
+    for (auto &g : spc1.groups) { // molecular groups with mass centers of the active particles
+        g.atomic = false;
+        g.cm = Geometry::massCenter(g.begin(), g.end(), spc1.geo.getBoundaryFunc(), -g.begin()->pos);
+    }
+    spc1.p[4].getExt().mu = {0, 0, 1};
+    spc1.p[4].getExt().mulen = 2.8;
+
+    std::string file = "checkpoint_test.ckpt";
+    FormatCheckpoint::save(file, spc1, {{"step", 42}});
+    auto meta = FormatCheckpoint::load(file, spc2);
+    std::remove(file.c_str());
+
+    CHECK(meta.at("step") == 42);
+    CHECK(spc2.geo.getLength().z() == doctest::Approx(30));
+    REQUIRE(spc2.p.size() == spc1.p.size());
+    REQUIRE(spc2.groups.size() == 2);
+    CHECK(spc2.p[1].pos.x() == doctest::Approx(-4));
+    CHECK(spc2.p[5].charge == doctest::Approx(-0.5));
+    CHECK(spc2.p[5].id == 1);
+    CHECK(spc2.p[0].hasExtension() == false);
+    CHECK(json(spc2.p[4]) == json(spc1.p[4]));
+    CHECK(spc2.groups[1].begin() == spc2.p.begin() + 3);
+    CHECK(spc2.groups[1].size() == 2);
+    CHECK(spc2.groups[1].capacity() == 3);
+    CHECK(spc2.groups[1].confid == 2);
+    CHECK(spc2.groups[0].cm.x() == doctest::Approx(spc1.groups[0].cm.x()));
+    CHECK_THROWS(FormatCheckpoint::load(file, spc2));
+
+    // inconsistent spaces are rejected when loading
+    auto reload = [&](Tspace &spc) {
+        FormatCheckpoint::save(file, spc);
+        Tspace loaded;
+        auto cleanup = [&] { std::remove(file.c_str()); };
+        try {
+            FormatCheckpoint::load(file, loaded);
+        } catch (...) {
+            cleanup();
+            throw;
+        }
+        cleanup();
+    };
+    CHECK_NOTHROW(reload(spc1));
+    spc1.groups[1].cm.x() += 1;
+    CHECK_THROWS(reload(spc1)); // wrong mass center
+    spc1.groups[1].cm.x() -= 1;
+    spc1.groups.pop_back();
+    CHECK_THROWS(reload(spc1)); // particles not covered by any group
+}
+
+TEST_CASE("[Faunus] XTCWriter") {
+    Tspace spc;
+    spc.geo = R"( {"type": "cuboid", "length": [10, 20, 30]} )"_json;
+    atoms.resize(1);
+    Particle a;
+    a.id = 0;
+    spc.push_back(0, Tspace::Tpvec(4, a));
+    auto move = [&](int frame) {
+        for (size_t i = 0; i < spc.p.size(); i++)
+            spc.p[i].pos = Point(i - 1.5, 0.1 * frame, -0.2 * frame * i);
+    };
+
+    // frames packed for the background writer are identical to directly written ones
+    std::string direct = "xtcwriter_direct.xtc", queued = "xtcwriter_queued.xtc";
+    {
+        FormatXTC xtc(1e6);
+        XTCWriter writer(queued, 2);
+        for (int frame = 0; frame < 5; frame++) {
+            move(frame);
+            Point box = spc.geo.getLength();
+            xtc.setbox(box);
+            xtc.save(direct, spc.p.begin(), spc.p.end());
+            writer.push(box, [&](std::vector<float> &x) { FormatXTC::pack(spc.p.begin(), spc.p.end(), box, x); });
+        }
+        writer.flush();
+    } // files are closed
+
+    Change change;
+    change.all = true;
+    Tspace spc_direct, spc_queued;
+    spc_direct.sync(spc, change);
+    spc_queued.sync(spc, change);
+    FormatXTC xtc_direct(1e6), xtc_queued(1e6);
+    REQUIRE(xtc_direct.open(direct));
+    REQUIRE(xtc_queued.open(queued));
+    int frames = 0;
+    while (xtc_direct.loadnextframe(spc_direct)) {
+        REQUIRE(xtc_queued.loadnextframe(spc_queued));
+        CHECK(spc_direct.geo.getLength().z() == Approx(spc_queued.geo.getLength().z()));
+        for (size_t i = 0; i < spc.p.size(); i++)
+            CHECK((spc_direct.p[i].pos - spc_queued.p[i].pos).norm() == Approx(0));
+        frames++;
+    }
+    CHECK(frames == 5);
+    CHECK(not xtc_queued.loadnextframe(spc_queued));
+    std::remove(direct.c_str());
+    std::remove(queued.c_str());
+}
+
 TEST_SUITE_END();
 } // namespace Faunus
@@ -15,6 +15,12 @@ void SpeciationMove::_to_json(json &j) const {
     for (auto &m : accmap)
         _j[m.first] = {{"attempts", m.second.cnt}, {"acceptance", m.second.avg()}};
     Faunus::_roundjson(_j, 3);
+    if (cavities)
+        j["cavity"] = {{"radius", cavities->radius}, {"spacing", cavities->spacing}};
+}
+void SpeciationMove::_from_json(const json &j) {
+    if (j.count("cavity") == 1)
+        cavities = RandomInserter::makeCavities(j.at("cavity"));
 }
 void SpeciationMove::setOther(Tspace &ospc) { otherspc = &ospc; }
 void SpeciationMove::_move(Change &change) {
@@ -95,6 +101,8 @@ void SpeciationMove::_move(Change &change) {
         }
 
         bondenergy = 0;
+        cavity_bias = 0;
+        deleted.clear();
 
         change.dN = true; // Attempting to change the number of atoms / molecules
 
@@ -122,6 +130,7 @@ void SpeciationMove::_move(Change &change) {
                         std::iter_swap(othergit->end() - dist - N, othergit->end() - (1 + N));
                     }
                     d.atoms.push_back(Faunus::distance(git->begin(), nait));
+                    deleted.push_back(nait->pos);
                     git->deactivate(nait, git->end());
                 }
                 std::sort(d.atoms.begin(), d.atoms.end());
@@ -143,6 +152,7 @@ void SpeciationMove::_move(Change &change) {
                         Potential::setBondEnergyFunction(bondclone, spc.p);
                         bondenergy += bondclone->energy(spc.geo.getDistanceFunc());
                     }
+                    deleted.push_back(git->cm);
                     git->deactivate(git->begin(), git->end());
                     Change::data d;
                     d.index = Faunus::distance(spc.groups.begin(), git); // integer *index* of moved group
@@ -155,6 +165,31 @@ void SpeciationMove::_move(Change &change) {
             }
         }
 
+        /*
+         * Cavity-biased insertion: products are placed in cavities of the configuration
+         * without reagents and products. This is also the configuration used in the reverse
+         * move, wherefore deleted reagents must be located in these cavities.
+         */
+        std::function<void(Point &)> randompos = [&](Point &pos) { spc.geo.randompos(pos, slump); };
+        if (cavities) {
+            std::vector<Point> positions;
+            for (auto &i : spc.activeParticles())
+                positions.push_back(i.pos);
+            cavities->update(spc.geo, positions);
+            int inserted = 0;
+            for (auto &m : rit->Molecules2Add(forward))
+                inserted += m.second;
+            if (cavities->empty() and inserted > 0)
+                cavity_bias = pc::infty;
+            else {
+                cavity_bias = (int(deleted.size()) - inserted) * std::log(cavities->fraction());
+                randompos = [&](Point &pos) { cavities->randompos(pos, slump); };
+            }
+            for (auto &pos : deleted)
+                if (not cavities->isCavity(pos))
+                    cavity_bias = pc::infty; // the reverse move is impossible
+        }
+
         // Activate products
         for (auto &m : rit->Molecules2Add(forward)) { // Add
             auto mollist = spc.findMolecules(m.first, Tspace::ALL);
@@ -170,7 +205,7 @@ void SpeciationMove::_move(Change &change) {
                 for (int N = 0; N < m.second; N++) { // Activate m.second m.first atoms
                     git->activate(git->end(), git->end() + 1);
                     auto ait = git->end() - 1;
-                    spc.geo.randompos(ait->pos, slump);
+                    randompos(ait->pos);
                     spc.geo.getBoundaryFunc()(ait->pos);
                     d.atoms.push_back(Faunus::distance(git->begin(), ait)); // Index of particle rel. to group
                 }
@@ -186,7 +221,7 @@ void SpeciationMove::_move(Change &change) {
                     auto git = slump.sample(mollist.begin(), mollist.end());
                     git->activate(git->inactive().begin(), git->inactive().end());
                     Point cm = git->cm;
-                    spc.geo.randompos(cm, slump);
+                    randompos(cm);
                     git->translate(cm, spc.geo.getBoundaryFunc());
                     Point u = ranunit(slump);
                     Eigen::Quaterniond Q(Eigen::AngleAxisd(2 * pc::pi * (slump() - 0.5), u));
@@ -220,8 +255,8 @@ double SpeciationMove::bias(Change &, double, double) {
     // The acceptance/rejection of the move is affected by the equilibrium constant
     // but unaffected by the change in bonded energy
     if (forward)
-        return -lnK + bondenergy;
-    return lnK + bondenergy;
+        return -lnK + bondenergy + cavity_bias;
+    return lnK + bondenergy + cavity_bias;
 }
 void SpeciationMove::_accept(Change &) {
     accmap[trialprocess->name] += 1;
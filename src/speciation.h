@@ -33,10 +33,13 @@ class SpeciationMove : public Movebase {
         atomcnt;                    // id's and number of inserted/deleted mols and atoms
     std::multimap<int, ParticleVector> pmap; // coordinates of mols and atoms to be inserted
     // unsigned int Ndeleted, Ninserted; // number of accepted deletions and insertions
+    std::shared_ptr<Geometry::CavityGrid> cavities; // if set, products are inserted into cavities only
+    std::vector<Point> deleted;                     // positions of deleted reagents (atoms or mass centers)
+    double cavity_bias = 0;                         // acceptance correction for cavity-biased insertion
 
     void _to_json(json &j) const override;
 
-    void _from_json(const json &) override{};
+    void _from_json(const json &) override;
 
   public:
     SpeciationMove(Space &spc);
@@ -24,6 +24,7 @@
 #include "space_test.h"
 #include "tensor_test.h"
 #include "externalpotential_test.h"
+#include "analysis_test.h"
 
 #include "mpicontroller.h"
 #include "auxiliary.h"
@@ -36,6 +37,9 @@
 #include "celllist.h"
 #include "functionparser.h"
 #include "multipole.h"
+#include "scatter.h"
+#include "context.h"
+#include "montecarlo.h"
 
 int main(int argc, char** argv) {
     Faunus::faunus_logger = spdlog::basic_logger_mt("faunus", "unittests.log", true);